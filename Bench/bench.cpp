@@ -0,0 +1,328 @@
+// Микробенчмарки горячих путей движка: find_turns, find_series, make_turn, calc_score, score_batch (по одной
+// позиции и AVX2), find_best_turns.
+// Результат - JSON (по одному бенчмарку на строку), который можно сравнить с прошлым прогоном:
+//   bench [--min-time MS] [--out FILE] [--compare OLD.json] [--threshold PERCENT]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../Engine/Logic.h"
+
+using namespace std;
+
+// счётчик выделений памяти: глобальный operator new считает каждый вызов
+static atomic<size_t> alloc_count{0};
+
+// все формы new и delete (массивы, варианты с размером) сводятся к одной паре malloc/free. Освобождение
+// не встраивается: иначе компилятор видит free от указателя из operator new (-Wmismatched-new-delete)
+static void *counted_alloc(size_t size)
+{
+    ++alloc_count;
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) static void counted_free(void *p) noexcept
+{
+    free(p);
+}
+
+void *operator new(size_t size)
+{
+    return counted_alloc(size);
+}
+
+void *operator new[](size_t size)
+{
+    return counted_alloc(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    counted_free(p);
+}
+
+// фиксированный набор позиций в записи parse_position (Engine/Position.h)
+const vector<pair<string, vector<string>>> Corpus = {
+    {"opening",
+     {".b.b.b.b", "b.b.b.b.", ".b.b.b.b", "........", "........", "w.w.w.w.", ".w.w.w.w", "w.w.w.w."}},
+    {"middlegame",
+     {".b.b.b.b", "b...b.b.", ".b.b...b", "..b.w...", "...w....", "w...w.w.", ".w.w...w", "w.w.w..."}},
+    {"kings",
+     {"...B....", "........", ".....W..", "..b.....", ".W...B..", "......w.", ".B...W..", "w......."}},
+    {"endgame",
+     {"........", "..b.....", "........", "....B...", "........", "..w.....", "...W....", "........"}},
+};
+
+// позиции международных шашек 10x10
+const vector<pair<string, vector<string>>> Corpus10 = {
+    {"opening10",
+     {".b.b.b.b.b", "b.b.b.b.b.", ".b.b.b.b.b", "b.b.b.b.b.", "..........", "..........", ".w.w.w.w.w",
+      "w.w.w.w.w.", ".w.w.w.w.w", "w.w.w.w.w."}},
+    {"middlegame10",
+     {".b.b.b.b.b", "b.b...b.b.", ".b.b.b...b", "b...b.b...", "...w...b..", "....w.w...", ".w...w.w.w",
+      "w.w.w...w.", ".w.w.w.w.w", "w.w.w.w.w."}},
+};
+
+struct bench_result
+{
+    string name;
+    string position;
+    size_t iterations = 0;
+    double ns_per_op = 0;
+    double nodes_per_sec = -1; // только для поиска
+    double allocs_per_op = 0;
+};
+
+// гоняет op пачками, пока суммарное время не превысит min_time_ms.
+// op возвращает число посещённых узлов (0, если понятие узла не применимо)
+bench_result run(const string &name, const string &position, const function<size_t()> &op, const int min_time_ms)
+{
+    bench_result res;
+    res.name = name;
+    res.position = position;
+    size_t batch = 1, nodes = 0, allocs = 0;
+    double total_ns = 0;
+    op(); // прогрев
+    while (total_ns < min_time_ms * 1e6)
+    {
+        const size_t allocs_before = alloc_count;
+        auto start = chrono::steady_clock::now();
+        for (size_t k = 0; k < batch; ++k)
+            nodes += op();
+        auto end = chrono::steady_clock::now();
+        allocs += alloc_count - allocs_before;
+        total_ns += chrono::duration<double, nano>(end - start).count();
+        res.iterations += batch;
+        batch *= 2;
+    }
+    res.ns_per_op = total_ns / res.iterations;
+    res.allocs_per_op = double(allocs) / res.iterations;
+    if (nodes)
+        res.nodes_per_sec = nodes / (total_ns / 1e9);
+    return res;
+}
+
+string to_json(const vector<bench_result> &results)
+{
+    ostringstream out;
+    out << "{\"benchmarks\": [\n";
+    for (size_t k = 0; k < results.size(); ++k)
+    {
+        const auto &r = results[k];
+        out << "  {\"name\": \"" << r.name << "\", \"position\": \"" << r.position << "\", \"iterations\": "
+            << r.iterations << ", \"ns_per_op\": " << r.ns_per_op << ", \"nodes_per_sec\": ";
+        if (r.nodes_per_sec < 0)
+            out << "null";
+        else
+            out << r.nodes_per_sec;
+        out << ", \"allocs_per_op\": " << r.allocs_per_op << "}" << (k + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]}\n";
+    return out.str();
+}
+
+// читает ns_per_op из файла, записанного to_json (по одному бенчмарку на строку)
+map<string, double> read_baseline(const string &path)
+{
+    map<string, double> res;
+    ifstream fin(path);
+    string line;
+    while (getline(fin, line))
+    {
+        auto field = [&line](const string &key) {
+            auto pos = line.find("\"" + key + "\": ");
+            if (pos == string::npos)
+                return string();
+            pos += key.size() + 4;
+            if (line[pos] == '"')
+                return line.substr(pos + 1, line.find('"', pos + 1) - pos - 1);
+            return line.substr(pos, line.find_first_of(",}", pos) - pos);
+        };
+        const string name = field("name"), position = field("position"), ns = field("ns_per_op");
+        if (!name.empty() && !ns.empty())
+            res[name + "/" + position] = stod(ns);
+    }
+    return res;
+}
+
+// все бенчмарки на позициях corpus для варианта G
+template <class G>
+void bench_corpus(const vector<pair<string, vector<string>>> &corpus, const int min_time_ms, vector<bench_result> &results)
+{
+    engine_settings settings;
+    settings.no_random = true;
+    Logic<G> logic(settings);
+    volatile double sink = 0;
+
+    for (const auto &pos : corpus)
+    {
+        const auto mtx = parse_position(pos.second);
+        const string &p = pos.first;
+
+        for (int color = 0; color < 2; ++color)
+        {
+            results.push_back(run("find_turns_color_" + to_string(color), p, [&]() {
+                logic.find_turns(bool(color), mtx);
+                sink = sink + logic.turns.size();
+                return size_t(0);
+            }, min_time_ms));
+        }
+
+        vector<pair<POS_T, POS_T>> squares;
+        for (POS_T i = 0; i < G::N; ++i)
+            for (POS_T j = 0; j < G::N; ++j)
+                if (mtx[i][j])
+                    squares.emplace_back(i, j);
+        size_t sq = 0;
+        results.push_back(run("find_turns_square", p, [&]() {
+            logic.find_turns(squares[sq].first, squares[sq].second, mtx);
+            sq = (sq + 1) % squares.size();
+            sink = sink + logic.turns.size();
+            return size_t(0);
+        }, min_time_ms));
+
+        results.push_back(run("find_series", p, [&]() {
+            sink = sink + logic.find_series(false, mtx).size();
+            return size_t(0);
+        }, min_time_ms));
+
+        logic.find_turns(false, mtx);
+        const auto moves = logic.turns;
+        if (!moves.empty())
+        {
+            size_t mv = 0;
+            results.push_back(run("make_turn", p, [&]() {
+                auto next = logic.make_turn(mtx, moves[mv]);
+                mv = (mv + 1) % moves.size();
+                sink = sink + next[0][1];
+                return size_t(0);
+            }, min_time_ms));
+        }
+
+        for (const string mode : {"NumberOnly", "NumberAndPotential"})
+        {
+            logic.scoring_mode = mode;
+            results.push_back(run("calc_score_" + mode, p, [&]() {
+                sink = sink + logic.calc_score(mtx, true);
+                return size_t(0);
+            }, min_time_ms));
+        }
+
+        // пакетная оценка детей позиции (как у узла над листьями): по одной и, если процессор умеет, AVX2
+        leaf_batch batch;
+        const auto parent = position_masks<G>(mtx);
+        for (const auto &series : logic.find_series(false, mtx))
+            batch.push(child_masks<G>(parent, mtx, series));
+        const size_t children = batch.size();
+        while (children && batch.size() < 16)
+            batch.push(batch.at(batch.size() % children));
+        vector<double> scores(batch.size() + 1);
+        for (const bool potential : {false, true})
+        {
+            const string mode = potential ? "NumberAndPotential" : "NumberOnly";
+            results.push_back(run("score_batch_scalar_" + mode, p, [&]() {
+                score_batch_scalar<G>(batch, potential, true, INF, scores.data());
+                sink = sink + scores[0];
+                return size_t(0);
+            }, min_time_ms));
+#if defined(FRONTIER_AVX2)
+            if (cpu_has_avx2())
+            {
+                results.push_back(run("score_batch_avx2_" + mode, p, [&]() {
+                    score_batch_avx2<G>(batch, potential, true, INF, scores.data());
+                    sink = sink + scores[0];
+                    return size_t(0);
+                }, min_time_ms));
+            }
+#endif
+        }
+
+        logic.scoring_mode = "NumberAndPotential";
+        for (int depth : {1, 3, 5})
+        {
+            logic.Max_depth = depth;
+            results.push_back(run("find_best_turns_depth_" + to_string(depth), p, [&]() {
+                sink = sink + logic.find_best_turns(false, mtx).steps.size();
+                return logic.nodes;
+            }, min_time_ms));
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int min_time_ms = 200;
+    double threshold = 10;
+    string out_path, compare_path;
+    for (int k = 1; k + 1 < argc; k += 2)
+    {
+        const string arg = argv[k];
+        if (arg == "--min-time")
+            min_time_ms = atoi(argv[k + 1]);
+        else if (arg == "--out")
+            out_path = argv[k + 1];
+        else if (arg == "--compare")
+            compare_path = argv[k + 1];
+        else if (arg == "--threshold")
+            threshold = atof(argv[k + 1]);
+    }
+
+    vector<bench_result> results;
+    bench_corpus<geometry<8>>(Corpus, min_time_ms, results);
+    bench_corpus<geometry<10>>(Corpus10, min_time_ms, results);
+
+    const string json_text = to_json(results);
+    cout << json_text;
+    if (!out_path.empty())
+    {
+        ofstream fout(out_path, ios_base::trunc);
+        fout << json_text;
+        fout.close();
+    }
+
+    // сравнение с прошлым прогоном: код возврата 1, если что-то замедлилось сильнее порога
+    if (compare_path.empty())
+        return 0;
+    const auto baseline = read_baseline(compare_path);
+    bool regression = false;
+    for (const auto &r : results)
+    {
+        auto it = baseline.find(r.name + "/" + r.position);
+        if (it == baseline.end() || it->second <= 0)
+            continue;
+        const double change = (r.ns_per_op / it->second - 1) * 100;
+        if (change > threshold)
+        {
+            regression = true;
+            cerr << "REGRESSION " << r.name << "/" << r.position << ": " << it->second << " -> " << r.ns_per_op
+                 << " ns/op (+" << change << "%)\n";
+        }
+    }
+    return regression ? 1 : 0;
+}
@@ -0,0 +1,844 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+#include "../Models/Move.h"
+#include "Log.h"
+#include "Settings.h"
+
+using namespace std;
+
+template <class G> class Logic;
+
+// Распределённый поиск: координатор (Logic с engine = "Distributed") раздаёт ветки корня процессам-воркерам
+// (Tools/worker.cpp) по сокетам TCP или Unix. Сообщение - длина u32, тип u8 и поля little-endian:
+//   CONFIG  размер доски u8, оценка u8, оптимизация u8, предел ходов без прогресса u16
+//   JOB     поиск u32, задание u32, очередь хода u8, глубина u8, alpha f64, beta f64,
+//           хэши истории (u16 + u64 * n), позиция, ходы от корня (u8 + путь каждого хода)
+//   ALPHA   поиск u32, alpha f64 - новая нижняя граница корня для всех заданий поиска
+//   STOP    поиск u32 - поиск закончен, его задания больше не нужны
+//   RESULT  поиск u32, задание u32, оценка f64, узлы u64
+// Позиция - по 4 бита на тёмную клетку, ход - номера тёмных клеток пути (начало и клетки после каждого шага)
+enum class WireMessage : uint8_t
+{
+    CONFIG = 1,
+    JOB = 2,
+    ALPHA = 3,
+    STOP = 4,
+    RESULT = 5
+};
+
+// параметры распределения
+const size_t WorkerPrefetch = 2;      // заданий в очереди воркера: следующее ждёт, пока считается текущее
+const int ReassignMs = 100;           // задание дольше этого отдаётся ещё и свободному воркеру
+const int CoordinatorPollMs = 10;     // период проверки медленных заданий
+const int ConnectTimeoutMs = 1000;    // подключение к воркеру дольше этого - воркер недоступен
+const uint32_t MaxWireMessage = 1 << 20;
+// верхняя граница окна задания без ограничения (оценки не больше INF)
+const double OpenBound = numeric_limits<double>::infinity();
+
+class wire_writer
+{
+  public:
+    explicit wire_writer(const WireMessage type) : data(5, 0)
+    {
+        data[4] = uint8_t(type);
+    }
+
+    void put(const uint64_t value, const int bytes)
+    {
+        for (int k = 0; k < bytes; ++k)
+            data.push_back(uint8_t(value >> (8 * k)));
+    }
+
+    void put_double(const double value)
+    {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        put(bits, 8);
+    }
+
+    void put_bytes(const vector<uint8_t> &bytes)
+    {
+        data.insert(data.end(), bytes.begin(), bytes.end());
+    }
+
+    // позиция: клетка с номером k (номер тёмной клетки) - в байте k / 2, чётная - в младших битах
+    void put_position(const vector<vector<POS_T>> &mtx)
+    {
+        const int n = int(mtx.size());
+        const size_t first = data.size();
+        data.resize(first + n * n / 4, 0);
+        for (int i = 0; i < n; ++i)
+        {
+            for (int j = (i + 1) % 2; j < n; j += 2)
+            {
+                const int k = (i * n + j) / 2;
+                data[first + k / 2] |= uint8_t(mtx[i][j] << (4 * (k % 2)));
+            }
+        }
+    }
+
+    void put_path(const move_series &series, const int n)
+    {
+        put(series.steps.size() + 1, 1);
+        put((series.steps[0].x * n + series.steps[0].y) / 2, 1);
+        for (const auto &step : series.steps)
+            put((step.x2 * n + step.y2) / 2, 1);
+    }
+
+    // готовое сообщение: в начало записывается длина
+    const vector<uint8_t> &finish()
+    {
+        const uint32_t length = uint32_t(data.size() - 4);
+        for (int k = 0; k < 4; ++k)
+            data[k] = uint8_t(length >> (8 * k));
+        return data;
+    }
+
+  private:
+    vector<uint8_t> data;
+};
+
+// чтение полей сообщения; при выходе за конец ok становится false, а поля - нулями
+class wire_reader
+{
+  public:
+    wire_reader(const uint8_t *p, const uint8_t *end) : p(p), end(end)
+    {
+    }
+
+    uint64_t get(const int bytes)
+    {
+        if (end - p < bytes)
+        {
+            ok = false;
+            return 0;
+        }
+        uint64_t value = 0;
+        for (int k = 0; k < bytes; ++k)
+            value |= uint64_t(*p++) << (8 * k);
+        return value;
+    }
+
+    double get_double()
+    {
+        const uint64_t bits = get(8);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    vector<vector<POS_T>> get_position(const int n)
+    {
+        vector<vector<POS_T>> mtx(n, vector<POS_T>(n, 0));
+        if (end - p < n * n / 4)
+        {
+            ok = false;
+            return mtx;
+        }
+        for (int i = 0; i < n; ++i)
+        {
+            for (int j = (i + 1) % 2; j < n; j += 2)
+            {
+                const int k = (i * n + j) / 2;
+                const POS_T piece = POS_T((p[k / 2] >> (4 * (k % 2))) & 15);
+                ok = ok && piece <= 4;
+                mtx[i][j] = piece;
+            }
+        }
+        p += n * n / 4;
+        return mtx;
+    }
+
+    vector<uint8_t> get_path()
+    {
+        vector<uint8_t> path(get(1));
+        for (auto &square : path)
+            square = uint8_t(get(1));
+        return path;
+    }
+
+    bool ok = true;
+
+  private:
+    const uint8_t *p;
+    const uint8_t *end;
+};
+
+// путь хода в номерах тёмных клеток, как в put_path
+inline vector<uint8_t> series_path(const move_series &series, const int n)
+{
+    vector<uint8_t> path = {uint8_t((series.steps[0].x * n + series.steps[0].y) / 2)};
+    for (const auto &step : series.steps)
+        path.push_back(uint8_t((step.x2 * n + step.y2) / 2));
+    return path;
+}
+
+// соединение: входящие байты копятся в буфере, из него вынимаются целые сообщения
+class wire_connection
+{
+  public:
+    explicit wire_connection(const int fd = -1) : fd(fd)
+    {
+    }
+
+    // читает доступные байты; false - соединение закрыто или сломано
+    bool receive()
+    {
+#ifndef _WIN32
+        uint8_t chunk[1 << 14];
+        const ssize_t got = recv(fd, chunk, sizeof(chunk), 0);
+        if (got <= 0)
+            return false;
+        in.insert(in.end(), chunk, chunk + got);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // следующее целое сообщение из буфера; false, если его ещё нет
+    bool next(WireMessage &type, vector<uint8_t> &payload)
+    {
+        if (in.size() < 5)
+            return false;
+        const uint32_t length = uint32_t(in[0]) | uint32_t(in[1]) << 8 | uint32_t(in[2]) << 16 | uint32_t(in[3]) << 24;
+        if (in.size() < 4 + size_t(length))
+            return false;
+        type = WireMessage(in[4]);
+        payload.assign(in.begin() + 5, in.begin() + 4 + length);
+        in.erase(in.begin(), in.begin() + 4 + length);
+        return true;
+    }
+
+    // битое сообщение: длина больше предела протокола
+    bool broken() const
+    {
+        return in.size() >= 4 &&
+               (uint32_t(in[0]) | uint32_t(in[1]) << 8 | uint32_t(in[2]) << 16 | uint32_t(in[3]) << 24) > MaxWireMessage;
+    }
+
+    bool send(const vector<uint8_t> &message)
+    {
+#ifndef _WIN32
+    #ifdef MSG_NOSIGNAL
+        const int flags = MSG_NOSIGNAL; // закрытый сокет - ошибка записи, а не SIGPIPE
+    #else
+        const int flags = 0;
+    #endif
+        size_t sent = 0;
+        while (sent < message.size())
+        {
+            const ssize_t res = ::send(fd, message.data() + sent, message.size() - sent, flags);
+            if (res <= 0)
+                return false;
+            sent += size_t(res);
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void close_socket()
+    {
+#ifndef _WIN32
+        if (fd >= 0)
+            ::close(fd);
+#endif
+        fd = -1;
+        in.clear();
+    }
+
+    int fd;
+
+  private:
+    vector<uint8_t> in;
+};
+
+#ifndef _WIN32
+// подключение без блокировки дольше ConnectTimeoutMs: недоступный хост не задерживает ход
+inline bool connect_with_timeout(const int fd, const sockaddr *addr, const socklen_t length)
+{
+    const int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0)
+        return false;
+    bool ok = connect(fd, addr, length) == 0;
+    if (!ok && errno == EINPROGRESS)
+    {
+        pollfd pfd = {fd, POLLOUT, 0};
+        int error = 0;
+        socklen_t size = sizeof(error);
+        ok = poll(&pfd, 1, ConnectTimeoutMs) == 1 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size) == 0 &&
+             error == 0;
+    }
+    return fcntl(fd, F_SETFL, flags) == 0 && ok;
+}
+
+// адрес "unix:/path", "tcp:host:port" или "host:port" (для listen хост можно опустить: "tcp:9000", ":9000")
+inline int open_socket(string address, const bool listen_mode)
+{
+    if (address.compare(0, 5, "unix:") == 0)
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        const string path = address.substr(5);
+        if (path.size() >= sizeof(addr.sun_path))
+            return -1;
+        strcpy(addr.sun_path, path.c_str());
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        if (listen_mode)
+            unlink(path.c_str());
+        const bool ok = listen_mode ? bind(fd, (sockaddr *)&addr, sizeof(addr)) == 0 && listen(fd, 4) == 0
+                                    : connect_with_timeout(fd, (sockaddr *)&addr, sizeof(addr));
+        if (!ok)
+        {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+    if (address.compare(0, 4, "tcp:") == 0)
+        address = address.substr(4);
+    const auto colon = address.rfind(':');
+    const string host = colon == string::npos ? "" : address.substr(0, colon);
+    const string port = colon == string::npos ? address : address.substr(colon + 1);
+    addrinfo hints{}, *res = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = listen_mode ? AI_PASSIVE : 0;
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &res) != 0)
+        return -1;
+    int fd = -1;
+    for (addrinfo *ai = res; ai && fd < 0; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0)
+            continue;
+        const int one = 1;
+        if (listen_mode)
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        else
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // короткие сообщения без задержки
+        const bool ok = listen_mode ? bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, 4) == 0
+                                    : connect_with_timeout(fd, ai->ai_addr, ai->ai_addrlen);
+        if (!ok)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+#else
+inline int open_socket(const string &, const bool)
+{
+    return -1; // распределённый поиск только на POSIX, на Windows координатор ищет сам
+}
+#endif
+
+// Координатор распределённого поиска. Ветки корня (или, если ходов корня меньше, чем вдвое больше
+// воркеров, - пары ход-ответ) становятся заданиями. Каждому воркеру отдаётся до WorkerPrefetch заданий.
+// Новая лучшая оценка корня рассылается всем воркерам как alpha, и их поиск сужает окно на ходу.
+// Задание, которое считается дольше ReassignMs, отдаётся ещё и освободившемуся воркеру, первый ответ
+// принимается; задания отвалившегося воркера возвращаются в очередь, без воркеров - считаются на месте.
+// Воркер, молчащий с заданиями дольше worker_timeout_ms, и недоступный адрес исключаются до конца сессии;
+// после distributed_time_ms оставшиеся задания тоже считаются на месте
+template <class G> class Coordinator
+{
+  public:
+    Coordinator(const engine_settings &settings)
+        : settings(settings), rand_eng(!settings.no_random ? unsigned(time(0)) : 0)
+    {
+        engine_settings local_settings = settings;
+        local_settings.engine = "AlphaBeta";
+        local_settings.solver_pieces = 0;
+        local_settings.experience_file = "";
+        local = make_unique<Logic<G>>(local_settings);
+        string address;
+        for (const char c : settings.workers + ",")
+        {
+            if (c != ',' && c != ' ')
+                address += c;
+            else if (!address.empty())
+            {
+                workers.emplace_back();
+                workers.back().address = address;
+                address.clear();
+            }
+        }
+    }
+
+    void seed(const unsigned value)
+    {
+        rand_eng.seed(value);
+    }
+
+    ~Coordinator()
+    {
+        for (auto &w : workers)
+            w.conn.close_socket();
+    }
+
+    // кооперативный режим: ожидание ответов воркеров после каждого опроса (не реже CoordinatorPollMs)
+    // вызывает hook в том же потоке, поиск на месте - каждые every узлов. Hook вернул false - поиск
+    // бросается, ход выбирается среди уже посчитанных
+    void set_yield_hook(const function<bool()> &hook, const size_t every)
+    {
+        yield_hook = hook;
+        local->set_yield_hook(hook, every);
+    }
+
+    Coordinator(const Coordinator &) = delete;
+    Coordinator &operator=(const Coordinator &) = delete;
+
+    // лучший ход корня на глубину depth и его оценка (-1 - единственный ход, не искался); history - хэши
+    // истории до корня включительно. false, если ни один воркер не доступен (тогда ищет сам Logic) или поиск
+    // бросил yield_hook: оценки недосчитанных ходов корня остаются бесконечными, ход и оценка не годятся
+    bool search(const bool color, const vector<vector<POS_T>> &mtx, const vector<uint64_t> &history, const int depth,
+                move_series &best, double &score, size_t &nodes)
+    {
+        trace_span span("distributed");
+        if (!connect_workers())
+            return false;
+        ++search_id;
+        nodes = 1;
+        local->Max_depth = depth;
+        local->set_history_hashes(history);
+        root_moves = local->find_series(color, mtx);
+        // равные ходы выбираются случайно, как в search_root
+        shuffle(root_moves.begin(), root_moves.end(), rand_eng);
+        if (root_moves.empty())
+            return false;
+        if (root_moves.size() == 1)
+        {
+            best = root_moves[0]; // единственный ход искать незачем
+            score = -1;
+            return true;
+        }
+        make_jobs(color, mtx, history, depth);
+
+        alpha = -1;
+        best_root = 0;
+        aborted = false;
+        const auto deadline = chrono::steady_clock::now() + chrono::milliseconds(settings.distributed_time_ms);
+        size_t left = jobs.size();
+        while (left)
+        {
+            assign();
+            drop_silent_workers();
+            if (!alive() || chrono::steady_clock::now() >= deadline)
+            {
+                left -= run_locally(color, mtx, nodes);
+                break;
+            }
+            left -= receive(nodes);
+            if (yield_hook && !yield_hook())
+            {
+                aborted = true;
+                break;
+            }
+        }
+        const auto stopped = chrono::steady_clock::now();
+        for (auto &w : workers)
+        {
+            wire_writer stop(WireMessage::STOP);
+            stop.put(search_id, 4);
+            if (w.conn.fd >= 0)
+                w.conn.send(stop.finish());
+            // воркер, не ответивший за поиск, остаётся на подозрении: молчание копится до ответа
+            if (!w.inflight.empty())
+                w.silent += stopped - w.heard;
+            w.inflight.clear();
+        }
+
+        if (aborted)
+            return false;
+        best = root_moves[best_root];
+        score = root_score[best_root];
+        span.set("jobs", jobs.size());
+        span.set("nodes", nodes);
+        logger().debug("distributed", "", {{"jobs", jobs.size()}, {"workers", alive()}, {"nodes", nodes},
+                                           {"reassigned", reassigned}});
+        return true;
+    }
+
+  private:
+    struct worker_link
+    {
+        string address;
+        wire_connection conn;
+        vector<uint32_t> inflight; // задания, отданные воркеру и ещё без ответа
+        chrono::steady_clock::time_point heard; // последний ответ или начало работы над заданиями
+        chrono::steady_clock::duration silent{}; // молчание с заданиями в прошлых поисках после последнего ответа
+        bool dead = false;         // адрес недоступен или воркер замолчал: до конца сессии не подключается
+    };
+
+    struct dist_job
+    {
+        size_t root = 0;             // номер хода корня
+        vector<move_series> line;    // ходы от корня: ход корня и, при делении глубже, ответ
+        bool done = false;
+        int assigned = 0;            // у скольких воркеров задание сейчас считается
+        chrono::steady_clock::time_point started;
+    };
+
+    // подключение воркеров, которые ещё не подключены (оборвавшееся соединение восстанавливается к следующему
+    // поиску); адрес, к которому не удалось подключиться, больше не набирается
+    bool connect_workers()
+    {
+        for (auto &w : workers)
+        {
+            if (w.conn.fd >= 0 || w.dead)
+                continue;
+            w.conn = wire_connection(open_socket(w.address, false));
+            if (w.conn.fd < 0)
+            {
+                w.dead = true;
+                logger().warning("distributed", "worker unreachable", {{"address", w.address}});
+                continue;
+            }
+            wire_writer config(WireMessage::CONFIG);
+            config.put(G::N, 1);
+            config.put(settings.scoring_mode == "NumberOnly" ? 0 : 1, 1);
+            config.put(settings.optimization == "O0" ? 0 : (settings.optimization == "O2" ? 2 : 1), 1);
+            config.put(uint64_t(settings.no_progress_limit), 2);
+            if (!w.conn.send(config.finish()))
+                w.conn.close_socket();
+            else
+                logger().info("distributed", "worker connected", {{"address", w.address}});
+        }
+        return alive() > 0;
+    }
+
+    size_t alive() const
+    {
+        size_t count = 0;
+        for (const auto &w : workers)
+            count += w.conn.fd >= 0;
+        return count;
+    }
+
+    void make_jobs(const bool color, const vector<vector<POS_T>> &mtx, const vector<uint64_t> &history, const int depth)
+    {
+        jobs.clear();
+        pending.clear();
+        reassigned = 0;
+        root_score.assign(root_moves.size(), OpenBound);
+        root_left.assign(root_moves.size(), 0);
+        // общая часть заданий поиска: очередь хода, глубина, история и позиция корня
+        wire_writer prefix(WireMessage::JOB);
+        prefix.put(color, 1);
+        prefix.put(uint64_t(depth), 1);
+        prefix.put(history.size(), 2);
+        for (const uint64_t hash : history)
+            prefix.put(hash, 8);
+        prefix.put_position(mtx);
+        const auto &bytes = prefix.finish();
+        job_prefix.assign(bytes.begin() + 5, bytes.end());
+
+        const bool split = depth >= 1 && root_moves.size() < 2 * alive();
+        for (size_t m = 0; m < root_moves.size(); ++m)
+        {
+            if (!split)
+            {
+                jobs.push_back({m, {root_moves[m]}, false, 0, {}});
+                ++root_left[m];
+                continue;
+            }
+            const auto replies = local->find_series(!color, root_moves[m].position);
+            // у соперника нет ходов - ветка считается целиком, как без деления
+            if (replies.empty())
+            {
+                jobs.push_back({m, {root_moves[m]}, false, 0, {}});
+                ++root_left[m];
+            }
+            for (const auto &reply : replies)
+            {
+                jobs.push_back({m, {root_moves[m], reply}, false, 0, {}});
+                ++root_left[m];
+            }
+        }
+        for (uint32_t k = 0; k < jobs.size(); ++k)
+            pending.push_back(k);
+    }
+
+    vector<uint8_t> job_message(const uint32_t k) const
+    {
+        const dist_job &job = jobs[k];
+        wire_writer msg(WireMessage::JOB);
+        msg.put(search_id, 4);
+        msg.put(k, 4);
+        msg.put_bytes(job_prefix);
+        // при делении на пары ход-ответ оценка хода корня - минимум по ответам, это верхняя граница окна
+        msg.put_double(alpha);
+        msg.put_double(job.line.size() > 1 ? root_score[job.root] : OpenBound);
+        msg.put(job.line.size(), 1);
+        for (const auto &series : job.line)
+            msg.put_path(series, G::N);
+        return msg.finish();
+    }
+
+    // раздача заданий свободным воркерам; свободному воркеру без очереди - копия самого долгого задания
+    void assign()
+    {
+        const auto now = chrono::steady_clock::now();
+        for (size_t w = 0; w < workers.size(); ++w)
+        {
+            worker_link &link = workers[w];
+            while (link.conn.fd >= 0 && link.inflight.size() < WorkerPrefetch)
+            {
+                while (!pending.empty() && jobs[pending.front()].done)
+                    pending.pop_front();
+                uint32_t k;
+                if (!pending.empty())
+                {
+                    k = pending.front();
+                    pending.pop_front();
+                }
+                else if (link.inflight.empty() && slowest_job(now, k))
+                {
+                    ++reassigned;
+                }
+                else
+                {
+                    break;
+                }
+                if (!send_to(w, job_message(k)))
+                {
+                    pending.push_front(k);
+                    break;
+                }
+                if (!jobs[k].assigned++)
+                    jobs[k].started = now;
+                if (link.inflight.empty())
+                    link.heard = now;
+                link.inflight.push_back(k);
+            }
+        }
+    }
+
+    bool slowest_job(const chrono::steady_clock::time_point now, uint32_t &slowest) const
+    {
+        bool found = false;
+        for (const auto &w : workers)
+        {
+            for (const uint32_t k : w.inflight)
+            {
+                const dist_job &job = jobs[k];
+                if (job.done || job.assigned > 1 || now - job.started < chrono::milliseconds(ReassignMs))
+                    continue;
+                if (!found || job.started < jobs[slowest].started)
+                    slowest = k;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    bool send_to(const size_t w, const vector<uint8_t> &message)
+    {
+        if (workers[w].conn.send(message))
+            return true;
+        drop_worker(w);
+        return false;
+    }
+
+    // воркер отвалился: его задания, которые больше никто не считает, возвращаются в очередь
+    void drop_worker(const size_t w)
+    {
+        logger().warning("distributed", "worker lost", {{"address", workers[w].address}});
+        for (const uint32_t k : workers[w].inflight)
+        {
+            if (!--jobs[k].assigned && !jobs[k].done)
+                pending.push_front(k);
+        }
+        workers[w].inflight.clear();
+        workers[w].conn.close_socket();
+    }
+
+    // воркер с заданиями, от которого нет ответа дольше worker_timeout_ms (завис или остановлен), исключается:
+    // его задания возвращаются в очередь. Молчание считается и по прошлым поискам, которые закончились без него
+    void drop_silent_workers()
+    {
+        const auto now = chrono::steady_clock::now();
+        for (size_t w = 0; w < workers.size(); ++w)
+        {
+            worker_link &link = workers[w];
+            if (link.conn.fd >= 0 && !link.inflight.empty() &&
+                link.silent + (now - link.heard) > chrono::milliseconds(settings.worker_timeout_ms))
+            {
+                drop_worker(w);
+                link.dead = true;
+            }
+        }
+    }
+
+    // ожидание ответов; возвращает число законченных заданий
+    size_t receive(size_t &nodes)
+    {
+#ifndef _WIN32
+        vector<pollfd> fds;
+        vector<size_t> index;
+        for (size_t w = 0; w < workers.size(); ++w)
+        {
+            if (workers[w].conn.fd >= 0)
+            {
+                fds.push_back({workers[w].conn.fd, POLLIN, 0});
+                index.push_back(w);
+            }
+        }
+        if (poll(fds.data(), fds.size(), CoordinatorPollMs) <= 0)
+            return 0;
+        size_t finished = 0;
+        for (size_t f = 0; f < fds.size(); ++f)
+        {
+            if (!fds[f].revents)
+                continue;
+            const size_t w = index[f];
+            if (!workers[w].conn.receive() || workers[w].conn.broken())
+            {
+                drop_worker(w);
+                continue;
+            }
+            workers[w].heard = chrono::steady_clock::now();
+            workers[w].silent = {};
+            WireMessage type;
+            vector<uint8_t> payload;
+            while (workers[w].conn.next(type, payload))
+            {
+                wire_reader r(payload.data(), payload.data() + payload.size());
+                const uint32_t id = uint32_t(r.get(4));
+                const uint32_t k = uint32_t(r.get(4));
+                const double score = r.get_double();
+                const size_t job_nodes = size_t(r.get(8));
+                if (type != WireMessage::RESULT || !r.ok || id != search_id || k >= jobs.size())
+                    continue; // ответ на прошлый поиск
+                auto &inflight = workers[w].inflight;
+                const auto it = find(inflight.begin(), inflight.end(), k);
+                if (it == inflight.end())
+                    continue;
+                inflight.erase(it);
+                --jobs[k].assigned;
+                nodes += job_nodes;
+                finished += finish_job(k, score);
+            }
+        }
+        return finished;
+#else
+        (void)nodes;
+        return 0;
+#endif
+    }
+
+    // оценка задания; ход корня, который уже не лучше alpha, снимает оставшиеся задания своих ответов
+    size_t finish_job(const uint32_t k, const double score)
+    {
+        dist_job &job = jobs[k];
+        if (job.done)
+            return 0;
+        job.done = true;
+        size_t finished = 1;
+        const size_t m = job.root;
+        root_score[m] = job.line.size() > 1 ? min(root_score[m], score) : score;
+        --root_left[m];
+        if (root_left[m] && root_score[m] <= alpha)
+        {
+            for (auto &other : jobs)
+            {
+                if (other.root == m && !other.done)
+                {
+                    other.done = true;
+                    ++finished;
+                }
+            }
+            root_left[m] = 0;
+        }
+        if (!root_left[m])
+            update_alpha(m);
+        return finished;
+    }
+
+    // ход корня m посчитан; лучший ход - первый посчитанный с наибольшей оценкой, как в search_root
+    void update_alpha(const size_t m)
+    {
+        if (root_score[m] <= alpha)
+            return;
+        alpha = root_score[m];
+        best_root = m;
+        wire_writer msg(WireMessage::ALPHA);
+        msg.put(search_id, 4);
+        msg.put_double(alpha);
+        const auto &bytes = msg.finish();
+        for (size_t w = 0; w < workers.size(); ++w)
+        {
+            if (workers[w].conn.fd >= 0)
+                send_to(w, bytes);
+        }
+    }
+
+    // все воркеры отвалились или вышло время: оставшиеся задания считаются на месте
+    size_t run_locally(const bool color, const vector<vector<POS_T>> &mtx, size_t &nodes)
+    {
+        size_t finished = 0;
+        for (uint32_t k = 0; k < jobs.size(); ++k)
+        {
+            if (jobs[k].done)
+                continue;
+            const double beta = jobs[k].line.size() > 1 ? root_score[jobs[k].root] : OpenBound;
+            const double score = local->search_line(color, mtx, jobs[k].line, alpha, beta);
+            nodes += local->nodes;
+            if (local->interrupted())
+            {
+                aborted = true;
+                break;
+            }
+            finished += finish_job(k, score);
+        }
+        return finished;
+    }
+
+  private:
+    const engine_settings settings;
+    unique_ptr<Logic<G>> local; // генерация ходов корня и поиск, когда воркеров нет
+    vector<worker_link> workers;
+    uint32_t search_id = 0;
+    vector<move_series> root_moves;
+    vector<double> root_score; // оценка хода корня (при делении на ответы - минимум по готовым ответам)
+    vector<size_t> root_left;  // заданий хода корня без ответа
+    vector<dist_job> jobs;
+    deque<uint32_t> pending;
+    vector<uint8_t> job_prefix;
+    double alpha = -1;
+    size_t best_root = 0;
+    size_t reassigned = 0;
+    default_random_engine rand_eng;
+    function<bool()> yield_hook;
+    bool aborted = false; // последний поиск бросил yield_hook
+};
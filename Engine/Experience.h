@@ -0,0 +1,312 @@
+#pragma once
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/file.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+using namespace std;
+
+// запись опыта: результат законченного поиска бота в позиции key
+struct experience_record
+{
+    uint64_t key = 0;   // хэш позиции с очередью хода и настройками оценки (experience_key)
+    double score = 0;   // оценка лучшего хода, как в root_line
+    uint32_t check = 0; // контрольная сумма записи: оборванная запись не читается
+    uint8_t depth = 0;  // глубина поиска (Max_depth)
+    uint8_t length = 0; // клеток в пути лучшего хода
+    uint8_t path[26] = {}; // путь хода в номерах тёмных клеток: начало и клетки после каждого шага
+};
+static_assert(sizeof(experience_record) == 48, "experience record must be 48 bytes");
+
+// Формат файла опыта (little-endian): "CKEX", версия u32, метка u64 (размер доски и ключи Зобриста),
+// затем записи experience_record. Файл только дописывается; повторная запись позиции заменяет прошлую,
+// если она не мельче. Когда файл больше предела, он сжимается: остаётся по одной записи на позицию,
+// при нехватке места - самые глубокие
+const char ExperienceMagic[4] = {'C', 'K', 'E', 'X'};
+const uint32_t ExperienceVersion = 1;
+const size_t ExperienceHeader = 16;
+
+// FNV-1a: контрольная сумма записей и соль ключа от настроек оценки
+inline uint64_t fnv_hash(const void *data, const size_t bytes, uint64_t hash = 0xcbf29ce484222325ull)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    for (size_t k = 0; k < bytes; ++k)
+        hash = (hash ^ p[k]) * 0x100000001b3ull;
+    return hash;
+}
+
+inline uint32_t experience_check(experience_record rec)
+{
+    rec.check = 0;
+    return uint32_t(fnv_hash(&rec, sizeof(rec))) | 1; // ноль - признак пустых байтов
+}
+
+// Хранилище опыта, общее для процессов: запись - дописывание в конец под исключительной блокировкой
+// файла (flock), чтение - без блокировок по отображению файла в память. Сжатие пишет новый файл
+// рядом и подменяет старый переименованием, поэтому читатель всегда видит целый файл; смену файла
+// он замечает по номеру inode и перечитывает индекс. На Windows хранилище выключено
+class experience_store
+{
+  public:
+    experience_store(const string &path, const size_t max_bytes, const uint64_t tag)
+        : path(path), max_bytes(max(max_bytes, ExperienceHeader + 64 * sizeof(experience_record))), tag(tag)
+    {
+    }
+
+    // запись позиции key, если она есть (с учётом записей других процессов)
+    bool find(const uint64_t key, experience_record &rec)
+    {
+        refresh();
+        const auto it = index.find(key);
+        if (it == index.end())
+            return false;
+        rec = it->second;
+        return true;
+    }
+
+    // дописывает запись; false, если файл не открылся или принадлежит другому формату
+    bool add(experience_record rec)
+    {
+#ifndef _WIN32
+        rec.check = experience_check(rec);
+        // файл могли подменить сжатием между open и flock: тогда блокировка взята на старом файле
+        for (int attempt = 0; attempt < 4; ++attempt)
+        {
+            const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+            if (fd < 0)
+                return false;
+            if (flock(fd, LOCK_EX) != 0 || !same_file(fd))
+            {
+                close(fd);
+                continue;
+            }
+            const bool ok = append_locked(fd, rec);
+            close(fd); // снимает блокировку
+            if (ok)
+                remember(rec);
+            return ok;
+        }
+        return false;
+#else
+        (void)rec;
+        return false;
+#endif
+    }
+
+    size_t size() const
+    {
+        return index.size();
+    }
+
+    // сжатие вне очереди (например, после смены предела размера)
+    bool compact()
+    {
+#ifndef _WIN32
+        const int fd = open(path.c_str(), O_RDWR);
+        if (fd < 0)
+            return false;
+        const bool ok = flock(fd, LOCK_EX) == 0 && same_file(fd) && compact_locked(fd);
+        close(fd);
+        return ok;
+#else
+        return false;
+#endif
+    }
+
+  private:
+#ifndef _WIN32
+    // открытый дескриптор - всё ещё файл по пути path
+    bool same_file(const int fd) const
+    {
+        struct stat by_fd, by_path;
+        return fstat(fd, &by_fd) == 0 && stat(path.c_str(), &by_path) == 0 && by_fd.st_ino == by_path.st_ino &&
+               by_fd.st_dev == by_path.st_dev;
+    }
+
+    bool append_locked(const int fd, const experience_record &rec)
+    {
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+            return false;
+        size_t bytes = size_t(st.st_size);
+        if (bytes == 0)
+        {
+            const vector<uint8_t> header = make_header();
+            if (write(fd, header.data(), header.size()) != ssize_t(header.size()))
+                return false;
+            bytes = header.size();
+        }
+        else
+        {
+            uint8_t header[ExperienceHeader];
+            if (pread(fd, header, sizeof(header), 0) != ssize_t(sizeof(header)) ||
+                memcmp(header, make_header().data(), sizeof(header)) != 0)
+                return false;
+            // хвост от оборванной записи (процесс упал посреди write): обрезаем до целой записи
+            const size_t whole = ExperienceHeader + (bytes - ExperienceHeader) / sizeof(rec) * sizeof(rec);
+            if (whole != bytes && ftruncate(fd, off_t(whole)) != 0)
+                return false;
+            bytes = whole;
+        }
+        if (write(fd, &rec, sizeof(rec)) != ssize_t(sizeof(rec)))
+            return false;
+        bytes += sizeof(rec);
+        return bytes <= max_bytes || compact_locked(fd);
+    }
+
+    // сжатие под блокировкой: по одной записи на позицию, не больше половины предела
+    bool compact_locked(const int fd)
+    {
+        vector<experience_record> records;
+        vector<size_t> written; // номер последней записи позиции в файле: позже записанные важнее
+        {
+            struct stat st;
+            if (fstat(fd, &st) != 0)
+                return false;
+            vector<uint8_t> data(size_t(st.st_size));
+            if (pread(fd, data.data(), data.size(), 0) != ssize_t(data.size()))
+                return false;
+            unordered_map<uint64_t, size_t> latest;
+            size_t count = 0;
+            for_each_record(data.data(), data.size(), ExperienceHeader, [&](const experience_record &rec) {
+                const auto it = latest.find(rec.key);
+                if (it == latest.end())
+                {
+                    latest.emplace(rec.key, records.size());
+                    records.push_back(rec);
+                    written.push_back(count);
+                }
+                else if (rec.depth >= records[it->second].depth)
+                {
+                    records[it->second] = rec;
+                    written[it->second] = count;
+                }
+                ++count;
+            });
+        }
+        const size_t limit = (max_bytes / 2 - ExperienceHeader) / sizeof(experience_record);
+        if (records.size() > limit)
+        {
+            // остаются самые глубокие; при равной глубине - записанные позже
+            vector<size_t> order(records.size());
+            for (size_t k = 0; k < order.size(); ++k)
+                order[k] = k;
+            sort(order.begin(), order.end(), [&records, &written](const size_t a, const size_t b) {
+                return records[a].depth != records[b].depth ? records[a].depth > records[b].depth
+                                                            : written[a] > written[b];
+            });
+            order.resize(limit);
+            sort(order.begin(), order.end());
+            vector<experience_record> kept;
+            kept.reserve(limit);
+            for (const size_t k : order)
+                kept.push_back(records[k]);
+            records = move(kept);
+        }
+
+        const string tmp_path = path + ".tmp";
+        FILE *f = fopen(tmp_path.c_str(), "wb");
+        if (!f)
+            return false;
+        const vector<uint8_t> header = make_header();
+        bool ok = fwrite(header.data(), 1, header.size(), f) == header.size() &&
+                  fwrite(records.data(), sizeof(experience_record), records.size(), f) == records.size();
+        ok = fclose(f) == 0 && ok;
+        if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0)
+        {
+            remove(tmp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+#endif
+
+    vector<uint8_t> make_header() const
+    {
+        vector<uint8_t> header(ExperienceMagic, ExperienceMagic + 4);
+        for (int k = 0; k < 4; ++k)
+            header.push_back(uint8_t(ExperienceVersion >> (8 * k)));
+        for (int k = 0; k < 8; ++k)
+            header.push_back(uint8_t(tag >> (8 * k)));
+        return header;
+    }
+
+    // целые записи с верной контрольной суммой начиная со смещения start; возвращает конец последней целой
+    // записи. Файл другого формата пропускается целиком
+    template <class F>
+    size_t for_each_record(const uint8_t *data, const size_t bytes, const size_t start, F on_record) const
+    {
+        if (bytes < ExperienceHeader || memcmp(data, make_header().data(), ExperienceHeader) != 0)
+            return start;
+        size_t pos = start;
+        for (; pos + sizeof(experience_record) <= bytes; pos += sizeof(experience_record))
+        {
+            experience_record rec;
+            memcpy(&rec, data + pos, sizeof(rec));
+            if (rec.check == experience_check(rec))
+                on_record(rec);
+        }
+        return pos;
+    }
+
+    void remember(const experience_record &rec)
+    {
+        auto it = index.find(rec.key);
+        if (it == index.end())
+            index.emplace(rec.key, rec);
+        else if (rec.depth >= it->second.depth)
+            it->second = rec;
+    }
+
+    // дочитывает записи, дописанные с прошлого раза; после сжатия (другой inode) индекс строится заново
+    void refresh()
+    {
+#ifndef _WIN32
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0)
+        {
+            index.clear();
+            parsed = 0;
+            return;
+        }
+        if (st.st_ino != inode || st.st_dev != device)
+        {
+            index.clear();
+            parsed = 0;
+            inode = st.st_ino;
+            device = st.st_dev;
+        }
+        if (size_t(st.st_size) <= parsed)
+            return;
+        // новые записи разбираются с места, где остановились в прошлый раз
+        mapped_file file(path);
+        if (file.is_open())
+        {
+            parsed = for_each_record(reinterpret_cast<const uint8_t *>(file.data()), file.size(),
+                                     parsed ? parsed : ExperienceHeader,
+                                     [this](const experience_record &rec) { remember(rec); });
+        }
+#endif
+    }
+
+    const string path;
+    const size_t max_bytes;
+    const uint64_t tag;
+    unordered_map<uint64_t, experience_record> index;
+    size_t parsed = 0; // байт файла, уже разобранных в индекс
+#ifndef _WIN32
+    ino_t inode = 0;
+    dev_t device = 0;
+#endif
+};
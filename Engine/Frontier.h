@@ -0,0 +1,286 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// ядро AVX2 собирается всегда на x86 под GCC/Clang (атрибут target) и выбирается при запуске по cpuid,
+// так что обычная сборка без -mavx2 работает на любом x86-64. Другие компиляторы берут ядро только
+// при сборке с AVX2 (MSVC /arch:AVX2)
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define FRONTIER_AVX2 1
+    #define FRONTIER_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(__AVX2__)
+    #define FRONTIER_AVX2 1
+    #define FRONTIER_AVX2_TARGET
+#endif
+
+#if defined(FRONTIER_AVX2)
+    #include <immintrin.h>
+#endif
+
+#include "../Models/Move.h"
+#include "Geometry.h"
+
+using namespace std;
+
+// Пакетная оценка листьев: позиция - маски тёмных клеток по типам фигур (бит - номер тёмной клетки,
+// как в move_series::captured). Оценка calc_score считается по маскам: число фигур - popcount,
+// потенциал шашек (номер ряда) - popcount масок рядов с k-м битом номера, умноженный на 2^k.
+// Все суммы целые (потенциал 0.05 за ряд - в двадцатых долях фигуры), поэтому пакет и одиночная
+// оценка дают одно и то же отношение при любом порядке сложения
+
+inline int popcount64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return int((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// фигуры позиции по типам: masks[1..4] - белые и чёрные шашки, белые и чёрные дамки
+struct piece_masks
+{
+    uint64_t masks[5] = {0, 0, 0, 0, 0};
+};
+
+// маски рядов доски G, считаются при компиляции
+template <int Size> struct row_mask_tables
+{
+    static constexpr int Bits = Size > 8 ? 4 : 3; // битов в номере ряда
+    // тёмные клетки, у которых k-й бит номера ряда i (для белых - N - 1 - i, расстояния до превращения) равен 1
+    uint64_t black_rows[4];
+    uint64_t white_rows[4];
+
+    constexpr row_mask_tables() : black_rows(), white_rows()
+    {
+        for (int i = 0; i < Size; ++i)
+        {
+            for (int j = (i + 1) % 2; j < Size; j += 2)
+            {
+                const uint64_t bit = uint64_t(1) << ((i * Size + j) / 2);
+                for (int k = 0; k < Bits; ++k)
+                {
+                    if ((i >> k) & 1)
+                        black_rows[k] |= bit;
+                    if (((Size - 1 - i) >> k) & 1)
+                        white_rows[k] |= bit;
+                }
+            }
+        }
+    }
+};
+
+template <class G> struct leaf_masks
+{
+    static constexpr row_mask_tables<G::N> Rows{};
+};
+
+template <class G> piece_masks position_masks(const vector<vector<POS_T>> &mtx)
+{
+    piece_masks res;
+    for (int i = 0; i < G::N; ++i)
+    {
+        for (int j = (i + 1) % 2; j < G::N; j += 2)
+            res.masks[mtx[i][j]] |= uint64_t(1) << G::Tables.dark_index[i][j];
+    }
+    res.masks[0] = 0;
+    return res;
+}
+
+// маски позиции после хода series из позиции с масками parent (mtx - позиция до хода):
+// фигура снимается с начальной клетки, побитые - со своих, на конечную ставится фигура из series.position
+// (она же учитывает превращение)
+template <class G>
+piece_masks child_masks(const piece_masks &parent, const vector<vector<POS_T>> &mtx, const move_series &series)
+{
+    piece_masks res = parent;
+    const move_pos &first = series.steps[0];
+    const move_pos &last = series.steps.back();
+    res.masks[mtx[first.x][first.y]] &= ~(uint64_t(1) << G::Tables.dark_index[first.x][first.y]);
+    for (int p = 1; p <= 4; ++p)
+        res.masks[p] &= ~series.captured;
+    res.masks[series.position[last.x2][last.y2]] |= uint64_t(1) << G::Tables.dark_index[last.x2][last.y2];
+    res.masks[0] = 0;
+    return res;
+}
+
+// оценка calc_score по маскам: отношение сил чёрных к белым (или наоборот при !first_bot_color),
+// INF - у стороны в знаменателе не осталось фигур, 0 - у стороны в числителе
+template <class G> double score_masks(const piece_masks &m, const bool potential, const bool first_bot_color,
+                                      const double inf)
+{
+    constexpr auto &rows = leaf_masks<G>::Rows;
+    const int king_coef = potential ? 5 : 4;
+    const int unit = potential ? 20 : 1;
+    long long white = (long long)popcount64(m.masks[1]) * unit + (long long)popcount64(m.masks[3]) * king_coef * unit;
+    long long black = (long long)popcount64(m.masks[2]) * unit + (long long)popcount64(m.masks[4]) * king_coef * unit;
+    if (potential)
+    {
+        for (int k = 0; k < rows.Bits; ++k)
+        {
+            white += (long long)popcount64(m.masks[1] & rows.white_rows[k]) << k;
+            black += (long long)popcount64(m.masks[2] & rows.black_rows[k]) << k;
+        }
+    }
+    bool white_empty = !(m.masks[1] | m.masks[3]);
+    bool black_empty = !(m.masks[2] | m.masks[4]);
+    if (!first_bot_color)
+    {
+        swap(white, black);
+        swap(white_empty, black_empty);
+    }
+    if (white_empty)
+        return inf;
+    if (black_empty)
+        return 0;
+    return double(black) / double(white);
+}
+
+// пакет листьев в виде структуры массивов: маски каждого типа фигур подряд, чтобы оценивать
+// несколько позиций одной векторной командой
+struct leaf_batch
+{
+    vector<uint64_t> white_men, black_men, white_kings, black_kings;
+
+    void clear()
+    {
+        white_men.clear();
+        black_men.clear();
+        white_kings.clear();
+        black_kings.clear();
+    }
+
+    void push(const piece_masks &m)
+    {
+        white_men.push_back(m.masks[1]);
+        black_men.push_back(m.masks[2]);
+        white_kings.push_back(m.masks[3]);
+        black_kings.push_back(m.masks[4]);
+    }
+
+    size_t size() const
+    {
+        return white_men.size();
+    }
+
+    piece_masks at(const size_t k) const
+    {
+        piece_masks m;
+        m.masks[1] = white_men[k];
+        m.masks[2] = black_men[k];
+        m.masks[3] = white_kings[k];
+        m.masks[4] = black_kings[k];
+        return m;
+    }
+};
+
+#if defined(FRONTIER_AVX2)
+// popcount четырёх 64-битных слов: таблица по полубайтам (vpshufb) и сумма байтов (vpsadbw)
+FRONTIER_AVX2_TARGET inline __m256i popcount4(const __m256i v)
+{
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1,
+                                           2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    const __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low));
+    const __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi64(v, 4), low));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+// неотрицательные целые меньше 2^52 в double: мантисса числа 2^52 + x
+FRONTIER_AVX2_TARGET inline __m256d small_to_double4(const __m256i v)
+{
+    const __m256d magic = _mm256_set1_pd(4503599627370496.0);
+    return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(v, _mm256_castpd_si256(magic))), magic);
+}
+
+// сумма фигур стороны в единицах оценки: шашки и дамки с весами, потенциал по маскам рядов
+FRONTIER_AVX2_TARGET inline __m256i side_weight4(const __m256i men, const __m256i kings, const uint64_t *rows,
+                                                const int bits, const bool potential)
+{
+    const int king_coef = potential ? 5 : 4;
+    const int unit = potential ? 20 : 1;
+    __m256i res = _mm256_add_epi64(_mm256_mul_epu32(popcount4(men), _mm256_set1_epi64x(unit)),
+                                   _mm256_mul_epu32(popcount4(kings), _mm256_set1_epi64x(king_coef * unit)));
+    if (potential)
+    {
+        for (int k = 0; k < bits; ++k)
+        {
+            const __m256i row = popcount4(_mm256_and_si256(men, _mm256_set1_epi64x((long long)rows[k])));
+            res = _mm256_add_epi64(res, _mm256_slli_epi64(row, k));
+        }
+    }
+    return res;
+}
+#endif
+
+// оценки позиций пакета с номера k до конца по одной, как score_masks
+template <class G>
+void score_batch_scalar(const leaf_batch &batch, const bool potential, const bool first_bot_color, const double inf,
+                        double *out, size_t k = 0)
+{
+    for (; k < batch.size(); ++k)
+        out[k] = score_masks<G>(batch.at(k), potential, first_bot_color, inf);
+}
+
+#if defined(FRONTIER_AVX2)
+// оценки позиций пакета по четыре за раз; возвращает число оценённых позиций (кратно четырём)
+template <class G>
+FRONTIER_AVX2_TARGET size_t score_batch_avx2(const leaf_batch &batch, const bool potential,
+                                             const bool first_bot_color, const double inf, double *out)
+{
+    size_t k = 0;
+    constexpr auto &rows = leaf_masks<G>::Rows;
+    const __m256i zero = _mm256_setzero_si256();
+    for (; k + 4 <= batch.size(); k += 4)
+    {
+        const __m256i wm = _mm256_loadu_si256((const __m256i *)&batch.white_men[k]);
+        const __m256i bm = _mm256_loadu_si256((const __m256i *)&batch.black_men[k]);
+        const __m256i wk = _mm256_loadu_si256((const __m256i *)&batch.white_kings[k]);
+        const __m256i bk = _mm256_loadu_si256((const __m256i *)&batch.black_kings[k]);
+        __m256i white = side_weight4(wm, wk, rows.white_rows, rows.Bits, potential);
+        __m256i black = side_weight4(bm, bk, rows.black_rows, rows.Bits, potential);
+        __m256d white_empty = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_or_si256(wm, wk), zero));
+        __m256d black_empty = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_or_si256(bm, bk), zero));
+        if (!first_bot_color)
+        {
+            swap(white, black);
+            swap(white_empty, black_empty);
+        }
+        __m256d res = _mm256_div_pd(small_to_double4(black), small_to_double4(white));
+        res = _mm256_blendv_pd(res, _mm256_setzero_pd(), black_empty);
+        res = _mm256_blendv_pd(res, _mm256_set1_pd(inf), white_empty);
+        _mm256_storeu_pd(out + k, res);
+    }
+    return k;
+}
+#endif
+
+// есть ли у процессора AVX2; проверка cpuid один раз за запуск
+inline bool cpu_has_avx2()
+{
+#if defined(FRONTIER_AVX2) && (defined(__GNUC__) || defined(__clang__))
+    static const bool res = __builtin_cpu_supports("avx2");
+    return res;
+#elif defined(FRONTIER_AVX2)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// оценки всех позиций пакета в out, как score_masks для каждой: по четыре позиции за раз, если
+// процессор умеет AVX2, остаток и процессоры без AVX2 - по одной
+template <class G>
+void score_batch(const leaf_batch &batch, const bool potential, const bool first_bot_color, const double inf,
+                 double *out)
+{
+    size_t k = 0;
+#if defined(FRONTIER_AVX2)
+    if (cpu_has_avx2())
+        k = score_batch_avx2<G>(batch, potential, first_bot_color, inf, out);
+#endif
+    score_batch_scalar<G>(batch, potential, first_bot_color, inf, out, k);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "../Models/Move.h"
+
+// диагональные направления в порядке перебора ходов: (-1,-1), (-1,+1), (+1,-1), (+1,+1)
+constexpr int DiagX[4] = {-1, -1, 1, 1};
+constexpr int DiagY[4] = {-1, 1, -1, 1};
+
+// таблицы доски Size x Size, считаются при компиляции
+template <int Size> struct geometry_tables
+{
+    // длина луча от клетки до края доски по каждому направлению:
+    // 0 - соседней клетки нет, 1 - есть сосед, но нет прыжка через него, больше - луч дамки
+    POS_T ray[Size][Size][4];
+    // номер тёмной клетки - бит в маске взятий move_series::captured
+    int dark_index[Size][Size];
+
+    constexpr geometry_tables() : ray(), dark_index()
+    {
+        for (int i = 0; i < Size; ++i)
+        {
+            for (int j = 0; j < Size; ++j)
+            {
+                for (int d = 0; d < 4; ++d)
+                {
+                    int len = 0;
+                    for (int i2 = i + DiagX[d], j2 = j + DiagY[d]; i2 >= 0 && i2 < Size && j2 >= 0 && j2 < Size;
+                         i2 += DiagX[d], j2 += DiagY[d])
+                        ++len;
+                    ray[i][j][d] = POS_T(len);
+                }
+                dark_index[i][j] = (i * Size + j) / 2;
+            }
+        }
+    }
+};
+
+// геометрия и правила варианта шашек, параметр шаблона Logic и Game.
+// 8x8 - русские шашки, 10x10 - международные; в обоих дамки дальнобойные, а простые шашки бьют и назад
+template <int Size> struct geometry
+{
+    static_assert(Size * Size / 2 <= 64, "capture mask must fit into 64 bits");
+
+    static constexpr int N = Size;
+    // рядов шашек у каждой стороны в начальной позиции
+    static constexpr int Men_rows = (Size - 2) / 2;
+    // русские шашки: шашка, дошедшая до последнего ряда во время взятия, сразу становится дамкой
+    // и продолжает бить как дамка; в международных превращение только в конце хода
+    static constexpr bool Promote_during_capture = Size == 8;
+    // международные шашки: обязательно взятие наибольшего числа фигур
+    static constexpr bool Majority_capture = Size == 10;
+    // международные шашки: побитые фигуры снимаются только после всей серии (турецкий удар) - до конца хода
+    // через них нельзя перепрыгнуть второй раз, пройти дамкой или встать на их клетку
+    static constexpr bool Remove_captured_at_end = Size == 10;
+
+    static constexpr geometry_tables<Size> Tables{};
+};
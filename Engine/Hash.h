@@ -0,0 +1,78 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#include "../Models/Move.h"
+
+using namespace std;
+
+// ключи Зобриста: по одному на каждую фигуру в каждой клетке и на очередь хода чёрных.
+// Таблица рассчитана на самую большую доску 10x10, доска 8x8 использует её угол
+struct zobrist_keys
+{
+    uint64_t piece[10][10][5];
+    uint64_t black_to_move;
+
+    zobrist_keys()
+    {
+        // splitmix64 с фиксированным зерном: хэши одинаковы между запусками
+        uint64_t state = 0x9E3779B97F4A7C15ull;
+        auto next = [&state]() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        };
+        for (auto &row : piece)
+            for (auto &cell : row)
+                for (auto &key : cell)
+                    key = next();
+        black_to_move = next();
+    }
+};
+
+inline const zobrist_keys &zobrist()
+{
+    static const zobrist_keys keys;
+    return keys;
+}
+
+// хэш позиции вместе с очередью хода (color: 0 - белые, 1 - чёрные)
+inline uint64_t position_hash(const vector<vector<POS_T>> &mtx, const bool color)
+{
+    const auto &keys = zobrist();
+    uint64_t hash = color ? keys.black_to_move : 0;
+    const POS_T n = POS_T(mtx.size());
+    for (POS_T i = 0; i < n; ++i)
+    {
+        for (POS_T j = (i + 1) % 2; j < n; j += 2)
+        {
+            if (mtx[i][j])
+                hash ^= keys.piece[i][j][mtx[i][j]];
+        }
+    }
+    return hash;
+}
+
+// ход между двумя соседними позициями - ход дамкой без взятия (не меняет материал и шашки)
+inline bool is_quiet_king_move(const vector<vector<POS_T>> &before, const vector<vector<POS_T>> &after)
+{
+    int changed = 0;
+    POS_T from = 0, to = 0;
+    const POS_T n = POS_T(before.size());
+    for (POS_T i = 0; i < n; ++i)
+    {
+        for (POS_T j = 0; j < n; ++j)
+        {
+            if (before[i][j] == after[i][j])
+                continue;
+            if (++changed > 2)
+                return false;
+            if (before[i][j])
+                from = before[i][j];
+            else
+                to = after[i][j];
+        }
+    }
+    return changed == 2 && from > 2 && from == to;
+}
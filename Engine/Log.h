@@ -0,0 +1,430 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+using namespace std;
+
+enum class LogLevel
+{
+    DEBUG,   // подробности поиска
+    INFO,    // время ходов, партий, запуска
+    WARNING, // нештатные, но не фатальные ситуации
+    ERROR    // ошибки SDL и загрузки ресурсов
+};
+
+// структурированное поле записи: ключ и число или строка.
+// Строка копируется в запись сразу, поэтому может быть временной
+struct log_field
+{
+    template <class T, class = enable_if_t<is_integral<T>::value>>
+    log_field(const char *key, const T value) : key(key), type(0), i((long long)value)
+    {
+    }
+    log_field(const char *key, const double value) : key(key), type(1), d(value)
+    {
+    }
+    log_field(const char *key, const char *value) : key(key), type(2), s(value)
+    {
+    }
+    log_field(const char *key, const string &value) : log_field(key, value.c_str())
+    {
+    }
+
+    const char *key;
+    int type;
+    union {
+        long long i;
+        double d;
+        const char *s;
+    };
+};
+
+// запись кольцевого буфера фиксированного размера, без выделений памяти
+struct log_record
+{
+    static const int MaxFields = 4;
+
+    uint64_t ts_ns = 0;  // время от открытия лога
+    uint64_t dur_ns = 0; // длительность интервала трассировки
+    uint32_t tid = 0;    // номер потока
+    LogLevel level = LogLevel::INFO;
+    char kind = 'L'; // 'L' - строка лога, 'X' - интервал трассировки, 'i' - мгновенное событие
+    char name[32] = {};
+    char text[128] = {};
+    int num_fields = 0;
+    char keys[MaxFields][16] = {};
+    char values[MaxFields][32] = {};
+};
+
+// Асинхронный лог: производители кладут записи в lock-free кольцевой буфер (MPSC, схема Вьюкова),
+// фоновый поток выводит их в log.txt и, если включено, в trace.json (формат Chrome trace event,
+// открывается в chrome://tracing или Perfetto). Производитель никогда не ждёт: при переполнении
+// запись отбрасывается и учитывается в счётчике dropped.
+class Logger
+{
+  public:
+    static const size_t Capacity = 2048; // степень двойки
+
+    Logger() : cells(new cell[Capacity])
+    {
+        for (size_t k = 0; k < Capacity; ++k)
+            cells[k].seq.store(k, memory_order_relaxed);
+    }
+
+    ~Logger()
+    {
+        close();
+    }
+
+    // открывает файлы и запускает фоновый поток; пустой trace_path - без трассировки
+    void open(const string &log_path, const string &trace_path, const LogLevel min_level)
+    {
+        close();
+        fout.open(log_path, ios_base::trunc);
+        if (!trace_path.empty())
+        {
+            trace_out.open(trace_path, ios_base::trunc);
+            trace_out << "{\"traceEvents\":[\n";
+            first_trace_event = true;
+        }
+        start_ns = steady_ns();
+        level = int(min_level);
+        is_tracing = trace_out.is_open();
+        stop = false;
+        is_open = true;
+        worker = thread(&Logger::drain_loop, this);
+    }
+
+    // дописывает оставшиеся записи и закрывает файлы. Новые записи уже не принимаются, а вставки, начатые
+    // до закрытия, дожидаются, чтобы фоновый поток вывел их при последнем проходе
+    void close()
+    {
+        if (!is_open)
+            return;
+        is_open = false;
+        is_tracing = false;
+        while (writers)
+            this_thread::yield();
+        stop = true;
+        worker.join();
+        if (dropped)
+            fout << "Logger dropped " << dropped << " records\n";
+        fout.close();
+        if (trace_out.is_open())
+        {
+            trace_out << "\n]}\n";
+            trace_out.close();
+        }
+    }
+
+    bool enabled(const LogLevel lvl) const
+    {
+        return is_open && int(lvl) >= level.load(memory_order_relaxed);
+    }
+
+    bool tracing() const
+    {
+        return is_tracing;
+    }
+
+    // время в наносекундах от открытия лога
+    uint64_t now_ns() const
+    {
+        return steady_ns() - start_ns.load(memory_order_relaxed);
+    }
+
+    void log(const LogLevel lvl, const char *event, const string &text = "", initializer_list<log_field> fields = {})
+    {
+        if (!enabled(lvl))
+            return;
+        log_record rec;
+        rec.ts_ns = now_ns();
+        rec.level = lvl;
+        fill(rec, event, fields);
+        snprintf(rec.text, sizeof(rec.text), "%s", text.c_str());
+        push(rec);
+    }
+
+    void debug(const char *event, const string &text = "", initializer_list<log_field> fields = {})
+    {
+        log(LogLevel::DEBUG, event, text, fields);
+    }
+
+    void info(const char *event, const string &text = "", initializer_list<log_field> fields = {})
+    {
+        log(LogLevel::INFO, event, text, fields);
+    }
+
+    void warning(const char *event, const string &text = "", initializer_list<log_field> fields = {})
+    {
+        log(LogLevel::WARNING, event, text, fields);
+    }
+
+    void error(const char *event, const string &text = "", initializer_list<log_field> fields = {})
+    {
+        log(LogLevel::ERROR, event, text, fields);
+    }
+
+    // завершённый интервал трассировки (событие "X")
+    void trace(const char *name, const uint64_t start_ns, const uint64_t dur_ns, initializer_list<log_field> fields = {})
+    {
+        if (!is_tracing)
+            return;
+        log_record rec;
+        rec.kind = 'X';
+        rec.ts_ns = start_ns;
+        rec.dur_ns = dur_ns;
+        fill(rec, name, fields);
+        push(rec);
+    }
+
+    // мгновенное событие трассировки (событие "i"), например сделанный ход
+    void instant(const char *name, initializer_list<log_field> fields = {})
+    {
+        if (!is_tracing)
+            return;
+        log_record rec;
+        rec.kind = 'i';
+        rec.ts_ns = now_ns();
+        fill(rec, name, fields);
+        push(rec);
+    }
+
+  private:
+    struct cell
+    {
+        atomic<size_t> seq;
+        log_record rec;
+    };
+
+    // наносекунды часов steady_clock
+    static uint64_t steady_ns()
+    {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static uint32_t thread_number()
+    {
+        static atomic<uint32_t> counter{0};
+        thread_local uint32_t id = ++counter;
+        return id;
+    }
+
+    static void fill(log_record &rec, const char *name, initializer_list<log_field> fields)
+    {
+        rec.tid = thread_number();
+        snprintf(rec.name, sizeof(rec.name), "%s", name);
+        for (const auto &f : fields)
+        {
+            if (rec.num_fields == log_record::MaxFields)
+                break;
+            snprintf(rec.keys[rec.num_fields], sizeof(rec.keys[0]), "%s", f.key);
+            char *value = rec.values[rec.num_fields];
+            if (f.type == 0)
+                snprintf(value, sizeof(rec.values[0]), "%lld", f.i);
+            else if (f.type == 1)
+                snprintf(value, sizeof(rec.values[0]), "%.3f", f.d);
+            else
+                snprintf(value, sizeof(rec.values[0]), "%s", f.s);
+            ++rec.num_fields;
+        }
+    }
+
+    // неблокирующая вставка нескольких производителей; после close() запись не принимается
+    void push(const log_record &rec)
+    {
+        ++writers;
+        if (!is_open)
+        {
+            --writers;
+            return;
+        }
+        size_t pos = enqueue_pos.load(memory_order_relaxed);
+        cell *c;
+        while (true)
+        {
+            c = &cells[pos & (Capacity - 1)];
+            const size_t seq = c->seq.load(memory_order_acquire);
+            const intptr_t diff = intptr_t(seq) - intptr_t(pos);
+            if (diff == 0)
+            {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                ++dropped; // буфер полон, фоновый поток не успевает
+                --writers;
+                return;
+            }
+            else
+            {
+                pos = enqueue_pos.load(memory_order_relaxed);
+            }
+        }
+        c->rec = rec;
+        c->seq.store(pos + 1, memory_order_release);
+        --writers;
+    }
+
+    // извлечение единственным потребителем
+    bool pop(log_record &rec)
+    {
+        cell *c = &cells[dequeue_pos & (Capacity - 1)];
+        if (c->seq.load(memory_order_acquire) != dequeue_pos + 1)
+            return false;
+        rec = c->rec;
+        c->seq.store(dequeue_pos + Capacity, memory_order_release);
+        ++dequeue_pos;
+        return true;
+    }
+
+    void drain_loop()
+    {
+        log_record rec;
+        while (true)
+        {
+            const bool stopping = stop;
+            bool any = false;
+            while (pop(rec))
+            {
+                write(rec);
+                any = true;
+            }
+            if (any)
+            {
+                fout.flush();
+                trace_out.flush();
+            }
+            if (stopping)
+                break;
+            if (!any)
+                this_thread::sleep_for(chrono::milliseconds(2));
+        }
+    }
+
+    void write(const log_record &rec)
+    {
+        static const char *LevelNames[] = {"DEBUG", "INFO", "WARNING", "ERROR"};
+        if (rec.kind == 'L')
+        {
+            char ts[32];
+            snprintf(ts, sizeof(ts), "[%10.3f] ", rec.ts_ns / 1e6);
+            fout << ts << LevelNames[int(rec.level)] << ' ' << rec.name;
+            if (rec.text[0])
+                fout << ": " << rec.text;
+            for (int k = 0; k < rec.num_fields; ++k)
+                fout << ' ' << rec.keys[k] << '=' << rec.values[k];
+            fout << '\n';
+            return;
+        }
+        if (!trace_out.is_open())
+            return;
+        char head[160];
+        snprintf(head, sizeof(head), "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u", rec.name,
+                 rec.kind, rec.ts_ns / 1e3, rec.tid);
+        trace_out << (first_trace_event ? "" : ",\n") << head;
+        first_trace_event = false;
+        if (rec.kind == 'X')
+            trace_out << ",\"dur\":" << rec.dur_ns / 1e3;
+        else
+            trace_out << ",\"s\":\"t\"";
+        trace_out << ",\"args\":{";
+        for (int k = 0; k < rec.num_fields; ++k)
+        {
+            trace_out << (k ? "," : "") << '"' << rec.keys[k] << "\":\"";
+            // кавычки и обратные слэши в значениях ломают JSON, заменяем их
+            for (const char *c = rec.values[k]; *c; ++c)
+                trace_out << ((*c == '"' || *c == '\\') ? '\'' : *c);
+            trace_out << '"';
+        }
+        trace_out << "}}";
+    }
+
+  private:
+    unique_ptr<cell[]> cells;
+    atomic<size_t> enqueue_pos{0};
+    size_t dequeue_pos = 0;
+    atomic<size_t> dropped{0};
+    atomic<bool> stop{false};
+    atomic<bool> is_open{false};
+    atomic<bool> is_tracing{false};
+    atomic<int> writers{0}; // производители внутри push
+    atomic<int> level{int(LogLevel::INFO)};
+    atomic<uint64_t> start_ns{steady_ns()}; // момент открытия лога по steady_ns
+    thread worker;
+    ofstream fout;
+    ofstream trace_out;
+    bool first_trace_event = true;
+};
+
+// общий лог процесса
+inline Logger &logger()
+{
+    static Logger instance;
+    return instance;
+}
+
+// интервал трассировки на время жизни объекта; без включённой трассировки ничего не стоит
+class trace_span
+{
+  public:
+    trace_span(const char *name)
+        : name(name), active(name && logger().tracing()), start(active ? logger().now_ns() : 0)
+    {
+    }
+
+    // числовое поле, которое попадёт в событие при закрытии интервала
+    void set(const char *key, const long long value)
+    {
+        if (num_fields < log_record::MaxFields)
+        {
+            keys[num_fields] = key;
+            values[num_fields++] = value;
+        }
+    }
+
+    ~trace_span()
+    {
+        if (!active)
+            return;
+        const uint64_t end = logger().now_ns();
+        switch (num_fields)
+        {
+        case 0:
+            logger().trace(name, start, end - start);
+            break;
+        case 1:
+            logger().trace(name, start, end - start, {{keys[0], values[0]}});
+            break;
+        case 2:
+            logger().trace(name, start, end - start, {{keys[0], values[0]}, {keys[1], values[1]}});
+            break;
+        case 3:
+            logger().trace(name, start, end - start,
+                           {{keys[0], values[0]}, {keys[1], values[1]}, {keys[2], values[2]}});
+            break;
+        default:
+            logger().trace(name, start, end - start,
+                           {{keys[0], values[0]}, {keys[1], values[1]}, {keys[2], values[2]}, {keys[3], values[3]}});
+            break;
+        }
+    }
+
+  private:
+    const char *name;
+    const bool active;
+    const uint64_t start;
+    const char *keys[log_record::MaxFields] = {};
+    long long values[log_record::MaxFields] = {};
+    int num_fields = 0;
+};
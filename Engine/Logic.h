@@ -0,0 +1,837 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cmath>
+#include <ctime>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "Geometry.h"
+#include "Hash.h"
+#include "Distributed.h"
+#include "Experience.h"
+#include "Frontier.h"
+#include "Log.h"
+#include "Mcts.h"
+#include "Position.h"
+#include "Settings.h"
+#include "Solver.h"
+
+using namespace std;
+
+const int INF = 1e9;
+// оценка ничьей: равное соотношение сил в шкале calc_score
+const double DRAW = 1;
+// параметры выборочного поиска O2
+const size_t LateMoveIndex = 3;   // тихие ходы начиная с этого номера ищутся на полуход короче
+const double FutilityMargin = 0.1; // относительный запас футильности за ход до листа
+const double RazorMargin = 0.3;    // относительный запас razoring за два хода до листа
+const double NullWindow = 1e-9;    // ширина нулевого окна проверочного поиска
+// побитая, но ещё не снятая фигура (Remove_captured_at_end): чётность как у бьющей стороны
+const POS_T CapturedByWhite = 5;
+const POS_T CapturedByBlack = 6;
+
+// ход корня с оценкой поиска (multi-PV)
+struct root_line
+{
+    move_series series;
+    double score = 0; // оценка calc_score после хода: INF - выигрыш, 0 - проигрыш
+};
+
+// движок варианта шашек G (Geometry.h): размер доски и правила известны при компиляции,
+// поэтому каждый размер получает собственный генератор ходов с развёрнутыми границами
+template <class G = geometry<8>> class Logic
+{
+  public:
+    Logic(const engine_settings &settings)
+    {
+        rand_eng = std::default_random_engine (
+            !settings.no_random ? unsigned(time(0)) : 0);
+        scoring_mode = settings.scoring_mode;
+        optimization = settings.optimization;
+        no_progress_limit = settings.no_progress_limit;
+        Multi_pv = settings.multi_pv;
+        Temperature = settings.temperature;
+        selective = optimization == "O2";
+        if (settings.engine == "MCTS")
+            mcts = make_unique<Mcts<G>>(settings);
+        if (settings.engine == "Distributed")
+            coordinator = make_unique<Coordinator<G>>(settings);
+        solver_pieces = settings.solver_pieces;
+        if (solver_pieces)
+            solver = make_unique<PnSolver<G>>(settings);
+        if (!settings.experience_file.empty())
+        {
+            // метка файла - формат позиций и ключи Зобриста, соль ключа - настройки, от которых зависит оценка
+            const uint64_t tag = zobrist().piece[1][0][1] ^ zobrist().black_to_move ^ (uint64_t(G::N) << 56);
+            const string salt = scoring_mode + "/" + optimization + "/" + to_string(no_progress_limit);
+            experience_salt = fnv_hash(salt.data(), salt.size());
+            experience = make_unique<experience_store>(settings.experience_file, settings.experience_mb << 20, tag);
+        }
+    }
+
+    // фиксирует генератор случайных чисел (воспроизводимые замеры и партии)
+    void seed(const unsigned value)
+    {
+        rand_eng.seed(value);
+        if (mcts)
+            mcts->seed(value);
+        if (coordinator)
+            coordinator->seed(value);
+    }
+
+    // кооперативный режим: поиск каждые every узлов вызывает hook в том же потоке (интерфейс разбирает
+    // события и выводит кадр). Так же отдают поток решатель (каждые every узлов), MCTS (перед каждой
+    // случайной партией) и координатор (после каждого опроса воркеров). Hook вернул false - поиск
+    // бросается, ход не важен. Пустой hook или every = 0 - поиск не отдаёт поток до конца расчёта
+    void set_yield_hook(const function<bool()> &hook, const size_t every)
+    {
+        Yield_hook = every ? hook : nullptr;
+        Yield_nodes = every;
+        const function<bool()> inner = Yield_hook ? function<bool()>([this]() { return yield(); }) : nullptr;
+        if (solver)
+        {
+            solver->Yield_hook = inner;
+            solver->Yield_nodes = every;
+        }
+        if (mcts)
+            mcts->Yield_hook = inner;
+        if (coordinator)
+            coordinator->set_yield_hook(inner, every);
+    }
+
+    // последний поиск бросил Yield_hook: его ход и оценка не годятся
+    bool interrupted() const
+    {
+        return stopped;
+    }
+
+    // история партии для поиска повторений: позиции после последнего необратимого хода
+    // (взятие или ход шашкой), color - очередь хода в последней позиции истории
+    void set_history(const vector<vector<vector<POS_T>>> &history, const bool color)
+    {
+        game_hashes.clear();
+        if (history.empty())
+            return;
+        size_t first = history.size() - 1;
+        while (first > 0 && is_quiet_king_move(history[first - 1], history[first]))
+            --first;
+        for (size_t k = first; k < history.size(); ++k)
+            game_hashes.push_back(position_hash(history[k], color ^ ((history.size() - 1 - k) % 2)));
+    }
+
+    // история партии готовыми хэшами (воркер распределённого поиска получает её от координатора)
+    void set_history_hashes(vector<uint64_t> hashes)
+    {
+        game_hashes = move(hashes);
+    }
+
+    // число ходов подряд дамками без взятий в конце истории партии
+    int history_quiet_plies() const
+    {
+        return game_hashes.empty() ? 0 : int(game_hashes.size()) - 1;
+    }
+
+   // поиск лучшего полного хода (серии взятий или тихого хода) для позиции mtx.
+   // При Temperature > 0 ход выбирается случайно среди Multi_pv лучших, чем хуже ход - тем реже
+   move_series find_best_turns(const bool color, const vector<vector<POS_T>> &mtx) {
+    const int root_quiet = start_path(color, mtx);
+
+    // в эндшпиле сначала пробуем доказать выигрыш; доказанный выигрыш играется без поиска
+    if (solver && count_pieces(mtx) <= solver_pieces) {
+        auto solved = solver->solve(color, mtx, root_quiet, false);
+        if (solved.result == 1) {
+            nodes = solved.nodes;
+            return solved.best;
+        }
+    }
+
+    // опыт прошлых поисков: лучший ход позиции, уже найденный на той же глубине или глубже. Только без
+    // обратимой истории перед корнем (от неё зависят повторения) и для выбора лучшего хода альфа-бетой
+    const bool use_experience = experience && !mcts && Temperature <= 0 && root_quiet == 0;
+    if (use_experience) {
+        move_series best;
+        if (recall(color, mtx, best))
+            return best;
+    }
+
+    // распределённый поиск: ветки корня считают воркеры; без воркеров - обычный поиск ниже
+    if (coordinator && Temperature <= 0) {
+        move_series best;
+        double score;
+        if (coordinator->search(color, mtx, path_hashes, Max_depth, best, score, nodes)) {
+            if (use_experience && score >= 0 && !stopped && isfinite(score))
+                record(color, mtx, best, score);
+            return best;
+        }
+    }
+
+    // движок MCTS: узлами считаются сыгранные случайные партии
+    if (mcts)
+        return mcts->search(color, mtx, root_quiet, nodes);
+
+    // без температуры нужен только лучший ход, остальные достаточно опровергнуть
+    auto lines = search_root(color, mtx, root_quiet, Temperature > 0 ? max<size_t>(1, Multi_pv) : 1);
+    if (use_experience && !lines.empty() && !stopped)
+        record(color, mtx, lines[0].series, lines[0].score);
+    return pick_line(lines);
+}
+
+    // count лучших ходов корня с точными оценками за один поиск альфа-бетой (анализ), по убыванию оценки
+    vector<root_line> find_top_turns(const bool color, const vector<vector<POS_T>> &mtx, const size_t count)
+    {
+        const int root_quiet = start_path(color, mtx);
+        return search_root(color, mtx, root_quiet, max<size_t>(1, count));
+    }
+
+    // оценка позиции после ходов line из позиции mtx (ветка корня и, возможно, ответ соперника) в окне
+    // (alpha, beta), как её получил бы поиск от корня: задание воркера распределённого поиска
+    double search_line(const bool color, const vector<vector<POS_T>> &mtx, const vector<move_series> &line,
+                       const double alpha, const double beta)
+    {
+        int quiet = start_path(color, mtx);
+        nodes = 1;
+        const vector<vector<POS_T>> *position = &mtx;
+        for (size_t k = 0; k < line.size(); ++k)
+        {
+            quiet = next_quiet(*position, line[k], quiet);
+            position = &line[k].position;
+            if (k + 1 < line.size())
+                path_hashes.push_back(position_hash(*position, color ^ ((k + 1) % 2)));
+        }
+        return find_best_turns_rec(*position, color ^ (line.size() % 2), line.size() - 1, alpha, beta, quiet);
+    }
+
+    // все полные ходы цвета color: серии взятий раскрываются целиком. При unique одинаковые по итоговой
+    // позиции серии (разный порядок взятий) остаются в одном экземпляре, иначе - все пути, как их может
+    // выбрать игрок. По правилу большинства остаются только серии с наибольшим числом взятий
+    vector<move_series> find_series(const bool color, const vector<vector<POS_T>> &mtx, const bool unique = true)
+    {
+        find_turns(color, mtx);
+        vector<move_series> res;
+        const auto first_moves = turns;
+        const bool beats = have_beats;
+        for (const auto &turn : first_moves)
+        {
+            move_series series;
+            series.steps.push_back(turn);
+            if (!beats)
+            {
+                series.position = make_turn(mtx, turn);
+                res.push_back(move(series));
+                continue;
+            }
+            series.position = capture_step(mtx, turn);
+            series.captured = capture_bit(turn.xb, turn.yb);
+            expand_series(series, res, unique);
+        }
+        if (G::Majority_capture && beats)
+        {
+            size_t most = 0;
+            for (const auto &series : res)
+                most = max(most, bitset<64>(series.captured).count());
+            res.erase(remove_if(res.begin(), res.end(),
+                                [most](const move_series &series) {
+                                    return bitset<64>(series.captured).count() < most;
+                                }),
+                      res.end());
+        }
+        return res;
+    }
+
+    // выполняет ход, обновляя доску; promote = false - шаг серии взятий без превращения в дамку
+    vector<vector<POS_T>> make_turn(vector<vector<POS_T>> mtx, move_pos turn, const bool promote = true) const
+    {
+        // если есть сбитая фигура, очищаем соответствующую ячейку
+        if (turn.xb != -1)
+            mtx[turn.xb][turn.yb] = 0;
+
+        // если шашка достигает последней линии, она становится дамкой
+        if (promote && is_promotion(mtx[turn.x][turn.y], turn.x2))
+            mtx[turn.x][turn.y] += 2; // превращаем шашку в дамку
+
+        // перемещаем фигуру на новое место
+        mtx[turn.x2][turn.y2] = mtx[turn.x][turn.y];
+        // очищаем исходную позицию фигуры
+        mtx[turn.x][turn.y] = 0;
+
+        // возвращаем обновленную доску
+        return mtx;
+    }
+
+
+    // вычисляет оценку текущего состояния доски: отношение сил чёрных к белым (при !first_bot_color - белых
+    // к чёрным), дамка весит 4 шашки, в режиме потенциала - 5 и шашка получает 0.05 за каждый пройденный ряд.
+    // Фигуры считаются по маскам тёмных клеток, как в пакетной оценке листьев (Frontier.h)
+double calc_score(const vector<vector<POS_T>> &mtx, const bool first_bot_color) const
+{
+    return score_masks<G>(position_masks<G>(mtx), scoring_mode == "NumberAndPotential", first_bot_color, INF);
+}
+
+    // сохранение и загрузка таблиц движка (таблица доказательств решателя), false - таблиц нет
+    bool save_tables(const string &path) const
+    {
+        return solver && solver->save_table(path);
+    }
+
+    bool load_tables(const string &path)
+    {
+        return solver && solver->load_table(path);
+    }
+
+    // длина серии ходов дамками без взятий после хода series из позиции mtx
+    static int next_quiet(const vector<vector<POS_T>> &mtx, const move_series &series, const int quiet)
+    {
+        const move_pos &first = series.steps[0];
+        return (!series.captured && mtx[first.x][first.y] > 2) ? quiet + 1 : 0;
+    }
+
+private:
+    // стек хэшей пути: история партии, если она заканчивается позицией mtx, иначе только корень.
+    // Возвращает число ходов дамками без взятий перед корнем
+    int start_path(const bool color, const vector<vector<POS_T>> &mtx)
+    {
+        const uint64_t root_hash = position_hash(mtx, color);
+        path_hashes.clear();
+        if (!game_hashes.empty() && game_hashes.back() == root_hash)
+            path_hashes = game_hashes;
+        else
+            path_hashes.push_back(root_hash);
+        stopped = false;
+        yield_at = Yield_hook && Yield_nodes ? Yield_nodes : numeric_limits<size_t>::max();
+        return int(path_hashes.size()) - 1;
+    }
+
+    // квант Yield_hook; false - поиск брошен сейчас или раньше за этот ход
+    bool yield()
+    {
+        stopped = stopped || !Yield_hook();
+        return !stopped;
+    }
+
+    // ход из хранилища опыта, если позиция искалась не мельче Max_depth; путь хода ищется среди полных ходов
+    bool recall(const bool color, const vector<vector<POS_T>> &mtx, move_series &best)
+    {
+        experience_record rec;
+        if (!experience->find(position_hash(mtx, color) ^ experience_salt, rec) || rec.depth < Max_depth)
+            return false;
+        const vector<uint8_t> path(rec.path, rec.path + rec.length);
+        for (auto &series : find_series(color, mtx, false)) {
+            if (series_path(series, G::N) == path) {
+                best = move(series);
+                nodes = 1;
+                logger().debug("experience", "hit", {{"depth", int(rec.depth)}, {"score", rec.score}});
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void record(const bool color, const vector<vector<POS_T>> &mtx, const move_series &best, const double score)
+    {
+        const vector<uint8_t> path = series_path(best, G::N);
+        experience_record rec;
+        if (path.size() > sizeof(rec.path) || Max_depth > 255)
+            return;
+        rec.key = position_hash(mtx, color) ^ experience_salt;
+        rec.score = score;
+        rec.depth = uint8_t(Max_depth);
+        rec.length = uint8_t(path.size());
+        copy(path.begin(), path.end(), rec.path);
+        if (!experience->add(rec))
+            logger().warning("experience", "cannot write");
+    }
+
+    // корень альфа-беты с count лучшими ходами: окно снизу - оценка count-го хода, поэтому ходы хуже
+    // него только опровергаются, а оценки вошедших в список точные. При count = 1 - обычный поиск
+    vector<root_line> search_root(const bool color, const vector<vector<POS_T>> &mtx, const int root_quiet,
+                                  const size_t count)
+    {
+        trace_span span("search");
+        nodes = 1; // счётчик посещённых узлов поиска, корень - первый узел
+
+        auto moves = find_series(color, mtx);
+        // равные ходы выбираются случайно (при no_random - с постоянным зерном): перемешивается только
+        // корень, узлы поиска на это время не тратят
+        shuffle(moves.begin(), moves.end(), rand_eng);
+        vector<root_line> lines;
+        for (auto &series : moves)
+        {
+            // каждая ветка корня - отдельный интервал на временной шкале трассировки
+            trace_span root_span("root_move");
+            const double bound = lines.size() < count ? -1 : lines.back().score;
+            // оцениваем позицию после всей серии для следующего игрока
+            const double move_score = find_best_turns_rec(series.position, 1 - color, 0, bound, INF + 1,
+                                                          next_quiet(mtx, series, root_quiet));
+            if (move_score <= bound)
+                continue;
+            // при равных оценках раньше найденный ход остаётся выше
+            auto it = find_if(lines.begin(), lines.end(),
+                              [move_score](const root_line &line) { return line.score < move_score; });
+            lines.insert(it, root_line{move(series), move_score});
+            if (lines.size() > count)
+                lines.pop_back();
+        }
+        span.set("depth", Max_depth);
+        span.set("nodes", nodes);
+        logger().debug("search", "", {{"depth", Max_depth}, {"nodes", nodes}, {"lines", lines.size()}});
+        return lines;
+    }
+
+    // оценка calc_score, приведённая к [0, 1]: 0 - проигрыш, 0.5 - равенство сил, 1 - выигрыш
+    static double line_value(const double score)
+    {
+        return score / (1 + score);
+    }
+
+    // выбор хода из лучших: softmax по оценкам с температурой Temperature, при 0 - всегда лучший
+    move_series pick_line(vector<root_line> &lines)
+    {
+        if (lines.empty())
+            return move_series();
+        if (Temperature <= 0 || lines.size() == 1)
+            return move(lines[0].series);
+        vector<double> weights;
+        for (const auto &line : lines)
+            weights.push_back(exp((line_value(line.score) - line_value(lines[0].score)) / Temperature));
+        discrete_distribution<size_t> choice(weights.begin(), weights.end());
+        return move(lines[choice(rand_eng)].series);
+    }
+
+    static uint64_t capture_bit(const POS_T x, const POS_T y)
+    {
+        return uint64_t(1) << G::Tables.dark_index[x][y];
+    }
+
+    // шашка piece, пришедшая в ряд row, становится дамкой
+    static bool is_promotion(const POS_T piece, const POS_T row)
+    {
+        return (piece == 1 && row == 0) || (piece == 2 && row == G::N - 1);
+    }
+
+    // позиция - ничья по правилам: повтор внутри обратимой серии или слишком долгая серия ходов дамками.
+    // Позиции с той же очередью хода лежат в стеке через одну
+    bool is_draw(const int quiet) const
+    {
+        if (no_progress_limit && quiet >= no_progress_limit)
+            return true;
+        const uint64_t hash = path_hashes.back();
+        const int size = int(path_hashes.size());
+        for (int k = size - 3; k >= 0 && k >= size - 1 - quiet; k -= 2)
+        {
+            if (path_hashes[k] == hash)
+                return true;
+        }
+        return false;
+    }
+
+    // продолжение серии взятий фигурой, стоящей в конце series; законченные серии добавляются в res
+    void expand_series(move_series &series, vector<move_series> &res, const bool unique)
+    {
+        const move_pos &last = series.steps.back();
+        find_turns(last.x2, last.y2, series.position);
+        if (!have_beats)
+        {
+            // побитые фигуры, оставленные на доске до конца серии, снимаются
+            if (G::Remove_captured_at_end)
+            {
+                for (const auto &step : series.steps)
+                    series.position[step.xb][step.yb] = 0;
+            }
+            // без превращения во время взятия шашка становится дамкой только в конце серии
+            POS_T &piece = series.position[last.x2][last.y2];
+            if (!G::Promote_during_capture && is_promotion(piece, last.x2))
+                piece += 2;
+            // серия закончена: пропускаем её, если та же позиция уже получена другим порядком взятий
+            for (const auto &other : res)
+            {
+                if (unique && other.captured == series.captured && other.steps[0].x == series.steps[0].x &&
+                    other.steps[0].y == series.steps[0].y && other.position == series.position)
+                    return;
+            }
+            res.push_back(series);
+            return;
+        }
+        const auto next_moves = turns;
+        for (const auto &turn : next_moves)
+        {
+            move_series next;
+            next.steps = series.steps;
+            next.steps.push_back(turn);
+            next.captured = series.captured | capture_bit(turn.xb, turn.yb);
+            next.position = capture_step(series.position, turn);
+            expand_series(next, res, unique);
+        }
+    }
+
+    // шаг серии взятий. При Remove_captured_at_end побитая фигура остаётся на месте до конца серии,
+    // помеченная как фигура цвета бьющего: свою фигуру нельзя бить, через неё нельзя пройти и встать на неё
+    vector<vector<POS_T>> capture_step(const vector<vector<POS_T>> &mtx, const move_pos &turn) const
+    {
+        vector<vector<POS_T>> res = make_turn(mtx, turn, G::Promote_during_capture);
+        if (G::Remove_captured_at_end)
+            res[turn.xb][turn.yb] = res[turn.x2][turn.y2] % 2 ? CapturedByWhite : CapturedByBlack;
+        return res;
+    }
+
+// рекурсивная функция для поиска лучшего хода (альфа-бета отсечение).
+// depth растёт на каждый полный ход, серия взятий - один ход; quiet - ходов дамками без взятий подряд
+double find_best_turns_rec(const std::vector<std::vector<POS_T>>& mtx, 
+                           const bool color, 
+                           const size_t depth, 
+                           double alpha = -1, 
+                           double beta = INF + 1,
+                           const int quiet = 0,
+                           const size_t skip = 0) {
+    ++nodes;
+    // кооперативный режим: каждые Yield_nodes узлов поиск на время отдаёт поток Yield_hook
+    if (nodes >= yield_at) {
+        yield_at = nodes + Yield_nodes;
+        yield();
+    }
+    if (stopped) {
+        return beta; // поиск брошен: оценка за окном сворачивает перебор, корень получает хоть какой-то ход
+    }
+    // повторения и серии без прогресса - ничья, циклы в эндшпиле дальше не перебираем
+    path_hashes.push_back(position_hash(mtx, color));
+    const double score = search_node(mtx, color, depth, alpha, beta, quiet, skip);
+    path_hashes.pop_back();
+    return score;
+}
+
+// узел поиска: depth - номер полухода (чётный - ход соперника бота, минимизация), skip - сколько
+// полуходов срезано сокращениями O2; лист, когда depth + skip достигает Max_depth
+double search_node(const std::vector<std::vector<POS_T>>& mtx, 
+                   const bool color, 
+                   const size_t depth, 
+                   double alpha, 
+                   double beta,
+                   const int quiet,
+                   const size_t skip) {
+    if (is_draw(quiet)) {
+        return DRAW;
+    }
+
+    // проверка глубины рекурсии
+    if (depth + skip >= size_t(Max_depth)) {
+        return calc_score(mtx, (depth % 2 == color)); // оцениваем доску
+    }
+
+    const bool maximize = depth % 2 == 1;
+    const size_t remaining = Max_depth - depth - skip;
+
+    // O2: у листьев отсекаем тихие узлы, статическая оценка которых далеко за границей окна
+    if (selective && remaining <= 2) {
+        double score;
+        if (prune_near_leaf(mtx, color, depth, alpha, beta, quiet, skip, remaining, score))
+            return score;
+    }
+
+    auto available_moves = find_series(color, mtx); // список доступных полных ходов
+
+    // если ходов больше нет, возвращаем значение на основе игрока
+    if (available_moves.empty()) {
+        return (depth % 2 == 0) ? INF : 0; // выигрыш для одного игрока и проигрыш для другого
+    }
+
+    // все ходы ведут в листья: оцениваем их одним пакетом
+    if (depth + skip + 1 >= size_t(Max_depth))
+        return search_frontier(mtx, color, depth, alpha, beta, quiet, available_moves);
+
+    // O2: сокращения поздних ходов имеют смысл только при упорядоченных ходах
+    const bool reduce_late = selective && remaining >= 3 && !available_moves[0].captured;
+    if (reduce_late)
+        order_moves(available_moves, depth % 2 == color, maximize);
+
+    // инициализируем оценки для альфа-бета отсечения
+    double min_score = INF + 1;
+    double max_score = -1;
+
+    // перебираем возможные ходы
+    for (size_t idx = 0; idx < available_moves.size(); ++idx) {
+        const auto& series = available_moves[idx];
+        const int child_quiet = next_quiet(mtx, series, quiet);
+        double move_score;
+        if (reduce_late && idx >= LateMoveIndex) {
+            // поздний тихий ход: сокращённый поиск с нулевым окном у текущей границы
+            move_score = maximize
+                ? find_best_turns_rec(series.position, 1 - color, depth + 1, alpha, alpha + NullWindow, child_quiet, skip + 1)
+                : find_best_turns_rec(series.position, 1 - color, depth + 1, beta - NullWindow, beta, child_quiet, skip + 1);
+            // ход неожиданно улучшает границу - проверяем его полным поиском
+            if (maximize ? move_score > alpha : move_score < beta)
+                move_score = find_best_turns_rec(series.position, 1 - color, depth + 1, alpha, beta, child_quiet, skip);
+        } else {
+            // оцениваем позицию после хода для следующего игрока
+            move_score = find_best_turns_rec(series.position, 1 - color, depth + 1, alpha, beta, child_quiet, skip);
+        }
+
+        // обновляем минимальную и максимальную оценки
+        min_score = std::min(min_score, move_score);
+        max_score = std::max(max_score, move_score);
+
+        // выполняем альфа-бета отсечение
+        if (depth % 2 == 0) {
+            beta = std::min(beta, min_score); // минимизируем для текущего игрока
+        } else {
+            alpha = std::max(alpha, max_score); // максимизируем для текущего игрока
+        }
+
+        // распределённый поиск: нижняя граница корня, найденная другими воркерами
+        if (Shared_alpha)
+            alpha = std::max(alpha, Shared_alpha->load(std::memory_order_relaxed));
+
+        if (alpha >= beta) {
+            return (depth % 2 == 0) ? min_score : max_score; // раннее завершение
+        }
+    }
+
+    // возвращаем результат в зависимости от хода
+    return (depth % 2 == 0) ? min_score : max_score;
+}
+
+// узел перед листьями: позиции всех ходов собираются в пакет масок (от масок узла, без обхода доски),
+// оцениваются вместе, и альфа-бета идёт уже по готовым оценкам. Узлы и отсечения - как при поиске по одному
+double search_frontier(const std::vector<std::vector<POS_T>>& mtx, const bool color, const size_t depth,
+                       double alpha, double beta, const int quiet, const vector<move_series>& moves) {
+    const piece_masks parent = position_masks<G>(mtx);
+    leaves.clear();
+    for (const auto& series : moves)
+        leaves.push(child_masks<G>(parent, mtx, series));
+    leaf_scores.resize(moves.size());
+    // листья оцениваются за сторону color ^ 1 на полуходе depth + 1, как в search_node
+    score_batch<G>(leaves, scoring_mode == "NumberAndPotential", (depth + 1) % 2 == size_t(!color), INF,
+                   leaf_scores.data());
+
+    double min_score = INF + 1;
+    double max_score = -1;
+    for (size_t idx = 0; idx < moves.size(); ++idx) {
+        ++nodes;
+        path_hashes.push_back(position_hash(moves[idx].position, !color));
+        const double move_score = is_draw(next_quiet(mtx, moves[idx], quiet)) ? DRAW : leaf_scores[idx];
+        path_hashes.pop_back();
+
+        min_score = std::min(min_score, move_score);
+        max_score = std::max(max_score, move_score);
+        if (depth % 2 == 0) {
+            beta = std::min(beta, min_score);
+        } else {
+            alpha = std::max(alpha, max_score);
+        }
+        if (Shared_alpha)
+            alpha = std::max(alpha, Shared_alpha->load(std::memory_order_relaxed));
+        if (alpha >= beta)
+            break;
+    }
+    return (depth % 2 == 0) ? min_score : max_score;
+}
+
+// футильность (за ход до листа) и razoring (за два хода) для O2. Работает только в тихих позициях:
+// при обязательном взятии статическая оценка ненадёжна. Запасы относительные, так как оценка - отношение сил
+bool prune_near_leaf(const std::vector<std::vector<POS_T>>& mtx, const bool color, const size_t depth,
+                     const double alpha, const double beta, const int quiet, const size_t skip,
+                     const size_t remaining, double &score) {
+    find_turns(color, mtx);
+    if (have_beats || turns.empty())
+        return false;
+    const double stand = calc_score(mtx, (depth % 2 == color));
+    if (stand <= 0 || stand >= INF)
+        return false;
+    const bool maximize = depth % 2 == 1;
+    const double margin = 1 + (remaining == 1 ? FutilityMargin : RazorMargin);
+    const bool hopeless = maximize ? stand * margin <= alpha : stand / margin >= beta;
+    if (!hopeless)
+        return false;
+    if (remaining == 1) {
+        score = stand;
+        return true;
+    }
+    // razoring: проверяем безнадёжность поиском на полуход короче с нулевым окном
+    score = maximize ? search_node(mtx, color, depth, alpha, alpha + NullWindow, quiet, skip + 1)
+                     : search_node(mtx, color, depth, beta - NullWindow, beta, quiet, skip + 1);
+    return maximize ? score <= alpha : score >= beta;
+}
+
+// упорядочивание ходов по статической оценке позиции после хода: лучшие для ходящего - первыми
+void order_moves(vector<move_series> &moves, const bool first_bot_color, const bool maximize) {
+    vector<pair<double, size_t>> keys;
+    for (size_t k = 0; k < moves.size(); ++k)
+        keys.emplace_back(calc_score(moves[k].position, first_bot_color) * (maximize ? -1 : 1), k);
+    stable_sort(keys.begin(), keys.end(),
+                [](const pair<double, size_t> &a, const pair<double, size_t> &b) { return a.first < b.first; });
+    vector<move_series> ordered;
+    ordered.reserve(moves.size());
+    for (const auto &key : keys)
+        ordered.push_back(move(moves[key.second]));
+    moves = move(ordered);
+}
+
+
+public:
+    // ищет все возможные ходы для заданного цвета на доске
+    void find_turns(const bool color, const vector<vector<POS_T>> &mtx)
+    {
+        vector<move_pos> res_turns;
+        bool have_beats_before = false;
+        for (POS_T i = 0; i < G::N; ++i)
+        {
+            // фигуры стоят только на тёмных клетках
+            for (POS_T j = (i + 1) % 2; j < G::N; j += 2)
+            {
+                if (mtx[i][j] && mtx[i][j] % 2 != color)
+                {
+                    find_turns(i, j, mtx);
+                    if (have_beats && !have_beats_before)
+                    {
+                        have_beats_before = true;
+                        res_turns.clear();
+                    }
+                    if ((have_beats_before && have_beats) || !have_beats_before)
+                    {
+                        res_turns.insert(res_turns.end(), turns.begin(), turns.end());
+                    }
+                }
+            }
+        }
+        turns = res_turns;
+        have_beats = have_beats_before;
+    }
+
+    // ищет все возможные ходы для конкретной позиции
+    void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>> &mtx)
+    {
+        turns.clear();
+        have_beats = false;
+        POS_T type = mtx[x][y];
+        // длины лучей из клетки (x, y) по четырём диагоналям
+        const POS_T *ray = G::Tables.ray[x][y];
+        // проверяет бьющие ходы
+        switch (type)
+        {
+        case 1:
+        case 2:
+            // проверяет шашки: прыжок через соседнюю фигуру соперника в любую сторону
+            for (int d = 0; d < 4; ++d)
+            {
+                if (ray[d] < 2)
+                    continue;
+                POS_T xb = x + DiagX[d], yb = y + DiagY[d];
+                POS_T i = xb + DiagX[d], j = yb + DiagY[d];
+                if (mtx[i][j] || !mtx[xb][yb] || mtx[xb][yb] % 2 == type % 2)
+                    continue;
+                turns.emplace_back(x, y, i, j, xb, yb);
+            }
+            break;
+        default:
+            // проверяет дамки
+            for (int d = 0; d < 4; ++d)
+            {
+                POS_T xb = -1, yb = -1;
+                POS_T i2 = x, j2 = y;
+                for (POS_T k = 0; k < ray[d]; ++k)
+                {
+                    i2 += DiagX[d];
+                    j2 += DiagY[d];
+                    if (mtx[i2][j2])
+                    {
+                        if (mtx[i2][j2] % 2 == type % 2 || (mtx[i2][j2] % 2 != type % 2 && xb != -1))
+                        {
+                            break;
+                        }
+                        xb = i2;
+                        yb = j2;
+                    }
+                    if (xb != -1 && xb != i2)
+                    {
+                        turns.emplace_back(x, y, i2, j2, xb, yb);
+                    }
+                }
+            }
+            break;
+        }
+        // проверяет другие ходы
+        if (!turns.empty())
+        {
+            have_beats = true;
+            return;
+        }
+        switch (type)
+        {
+        case 1:
+        case 2:
+            // проверяет шашки: белые ходят вверх (направления 0, 1), чёрные вниз (2, 3)
+            for (int d = (type % 2) ? 0 : 2, end = d + 2; d < end; ++d)
+            {
+                POS_T i = x + DiagX[d], j = y + DiagY[d];
+                if (!ray[d] || mtx[i][j])
+                    continue;
+                turns.emplace_back(x, y, i, j);
+            }
+            break;
+        default:
+            // проверяет дамки
+            for (int d = 0; d < 4; ++d)
+            {
+                POS_T i2 = x, j2 = y;
+                for (POS_T k = 0; k < ray[d]; ++k)
+                {
+                    i2 += DiagX[d];
+                    j2 += DiagY[d];
+                    if (mtx[i2][j2])
+                        break;
+                    turns.emplace_back(x, y, i2, j2);
+                }
+            }
+            break;
+        }
+    }
+
+
+  public:
+    vector<move_pos> turns;
+    bool have_beats;
+    int Max_depth;
+    // ходов корня с точной оценкой, из которых выбирает Temperature
+    size_t Multi_pv = 1;
+    // температура выбора хода в шкале line_value: 0 - всегда лучший, 1 - почти равновероятно среди Multi_pv лучших
+    double Temperature = 0;
+    string scoring_mode;
+    // количество узлов, посещённых последним find_best_turns
+    size_t nodes = 0;
+    // общая нижняя граница корня, которую поиск читает на ходу (воркер распределённого поиска)
+    const atomic<double> *Shared_alpha = nullptr;
+
+  private:
+    default_random_engine rand_eng;
+    string optimization;
+    int no_progress_limit = 0;
+    // включены сокращения и отсечения O2
+    bool selective = false;
+    // хэши позиций партии после последнего необратимого хода
+    vector<uint64_t> game_hashes;
+    // хэши позиций от начала обратимой серии до текущего узла поиска
+    vector<uint64_t> path_hashes;
+    // пакет листьев узла перед листьями и их оценки (буферы переиспользуются между узлами)
+    leaf_batch leaves;
+    vector<double> leaf_scores;
+    // кооперативный режим (set_yield_hook) и счётчик nodes, на котором снова вызывается Yield_hook;
+    // stopped - hook бросил поиск, все поиски этого хода сворачиваются
+    function<bool()> Yield_hook;
+    size_t Yield_nodes = 0;
+    size_t yield_at = numeric_limits<size_t>::max();
+    bool stopped = false;
+    // поиск MCTS вместо альфа-беты (настройка engine)
+    unique_ptr<Mcts<G>> mcts;
+    // распределённый поиск по воркерам (engine = "Distributed")
+    unique_ptr<Coordinator<G>> coordinator;
+    // хранилище опыта: результаты поисков между партиями и процессами (experience_file)
+    unique_ptr<experience_store> experience;
+    uint64_t experience_salt = 0;
+    // решатель df-pn для позиций с не более чем solver_pieces фигурами
+    unique_ptr<PnSolver<G>> solver;
+    int solver_pieces = 0;
+};
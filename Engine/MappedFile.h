@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+// файл только для чтения, отображённый в память: страницы подгружает ОС по мере чтения,
+// поэтому архивы в несколько гигабайт не копируются в память процесса. На Windows - читается целиком
+class mapped_file
+{
+  public:
+    explicit mapped_file(const string &path)
+    {
+#ifndef _WIN32
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (fstat(fd, &st) == 0)
+        {
+            bytes = size_t(st.st_size);
+            opened = true;
+            if (bytes)
+            {
+                void *addr = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr == MAP_FAILED)
+                {
+                    opened = false;
+                    bytes = 0;
+                }
+                else
+                {
+                    // чтение идёт от начала к концу: ОС подгружает страницы заранее
+                    madvise(addr, bytes, MADV_SEQUENTIAL);
+                    ptr = static_cast<const char *>(addr);
+                }
+            }
+        }
+        close(fd);
+#else
+        FILE *f = fopen(path.c_str(), "rb");
+        if (!f)
+            return;
+        char chunk[1 << 16];
+        size_t got;
+        while ((got = fread(chunk, 1, sizeof(chunk), f)) > 0)
+            buffer.insert(buffer.end(), chunk, chunk + got);
+        fclose(f);
+        opened = true;
+        bytes = buffer.size();
+        ptr = buffer.data();
+#endif
+    }
+
+    ~mapped_file()
+    {
+#ifndef _WIN32
+        if (ptr)
+            munmap(const_cast<char *>(ptr), bytes);
+#endif
+    }
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    bool is_open() const
+    {
+        return opened;
+    }
+
+    const char *data() const
+    {
+        return ptr;
+    }
+
+    size_t size() const
+    {
+        return bytes;
+    }
+
+  private:
+    const char *ptr = nullptr;
+    size_t bytes = 0;
+    bool opened = false;
+#ifdef _WIN32
+    vector<char> buffer;
+#endif
+};
@@ -0,0 +1,335 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "Geometry.h"
+#include "Log.h"
+#include "Settings.h"
+
+using namespace std;
+
+template <class G> class Logic;
+
+// параметры MCTS
+const double UctExploration = 1.0;        // коэффициент исследования в UCT (награды в [0, 1])
+const int PlayoutMoves = 120;             // предел ходов случайной партии, дальше - оценка по материалу
+const double PlayoutWinRatio = 1.5;       // соотношение сил, при котором оборванная партия засчитывается
+
+// узел дерева MCTS: позиция упакована по тёмным клеткам, статистика общая для всех потоков
+template <class G> struct mcts_node
+{
+    static const int Cells = G::N * G::N / 2;
+
+    POS_T cells[Cells];  // фигуры на тёмных клетках (номер - G::Tables.dark_index)
+    bool color = false;  // очередь хода в позиции
+    int quiet = 0;       // ходов дамками без взятий подряд
+    atomic<uint32_t> visits{0};
+    atomic<uint32_t> score{0};        // очки стороны, сделавшей ход в узел: победа - 2, ничья - 1
+    atomic<uint32_t> virtual_loss{0}; // потоки, проходящие через узел прямо сейчас
+    atomic<int> state{0};             // 0 - не раскрыт, 1 - раскрывается, 2 - раскрыт
+    uint32_t first_child = 0;         // дети лежат в пуле подряд
+    uint32_t num_children = 0;
+};
+
+// пул узлов: один массив на всё дерево, выделение - атомарный сдвиг границы, освобождение - сброс пула.
+// Массив выделяется при первом сбросе, то есть в первом поиске: Mcts, который не ищет, память не держит
+template <class G> class mcts_pool
+{
+  public:
+    mcts_pool(const int memory_mb) : capacity((size_t(max(1, memory_mb)) << 20) / sizeof(mcts_node<G>))
+    {
+    }
+
+    void reset()
+    {
+        if (!nodes)
+            nodes.reset(new mcts_node<G>[capacity]);
+        used = 0;
+    }
+
+    // выделяет count узлов подряд; false, если пул исчерпан
+    bool alloc(const size_t count, uint32_t &first)
+    {
+        const size_t start = used.fetch_add(count);
+        if (start + count > capacity)
+            return false;
+        for (size_t k = start; k < start + count; ++k)
+        {
+            mcts_node<G> &node = nodes[k];
+            node.visits = 0;
+            node.score = 0;
+            node.virtual_loss = 0;
+            node.state = 0;
+            node.first_child = 0;
+            node.num_children = 0;
+        }
+        first = uint32_t(start);
+        return true;
+    }
+
+    size_t size() const
+    {
+        return min(size_t(used), capacity);
+    }
+
+    mcts_node<G> &operator[](const size_t k)
+    {
+        return nodes[k];
+    }
+
+  private:
+    unique_ptr<mcts_node<G>[]> nodes;
+    const size_t capacity;
+    atomic<size_t> used{0};
+};
+
+// Монте-Карло поиск по дереву (UCT) со случайными партиями до конца. Потоки работают над одним деревом
+// (tree parallelism): пока поток спускается через узел, узел несёт виртуальное поражение, и другие
+// потоки уходят в соседние ветки. У каждого потока свой Logic для генерации ходов
+template <class G> class Mcts
+{
+  public:
+    Mcts(const engine_settings &settings)
+        : pool(settings.mcts_memory_mb), time_ms(settings.mcts_time_ms), max_playouts(settings.mcts_playouts),
+          no_progress_limit(settings.no_progress_limit)
+    {
+        engine_settings worker_settings = settings;
+        worker_settings.engine = "AlphaBeta";
+        worker_settings.solver_pieces = 0;
+        worker_settings.experience_file = "";
+        for (int t = 0; t < max(1, settings.threads); ++t)
+        {
+            workers.push_back(make_unique<Logic<G>>(worker_settings));
+            rand_engs.emplace_back((settings.no_random ? 0 : unsigned(time(0))) + unsigned(t));
+        }
+    }
+
+    void seed(const unsigned value)
+    {
+        for (size_t t = 0; t < workers.size(); ++t)
+        {
+            workers[t]->seed(value + unsigned(t));
+            rand_engs[t].seed(value + unsigned(t));
+        }
+    }
+
+    // кооперативный режим: поток, вызвавший search, перед каждой своей случайной партией вызывает
+    // Yield_hook, остальные потоки играют партии без остановок. Hook вернул false - поиск бросается
+    function<bool()> Yield_hook;
+
+    // лучший полный ход: самый посещённый ход корня. playouts - число сыгранных случайных партий
+    move_series search(const bool color, const vector<vector<POS_T>> &mtx, const int quiet, size_t &playouts)
+    {
+        trace_span span("mcts");
+        auto root_moves = workers[0]->find_series(color, mtx);
+        playouts = 0;
+        if (root_moves.size() <= 1)
+            return root_moves.empty() ? move_series() : root_moves[0];
+
+        // корень раскрывается заранее в порядке root_moves, чтобы ход находился по номеру ребёнка
+        pool.reset();
+        pool.alloc(1, root);
+        pack(mtx, pool[root]);
+        pool[root].color = color;
+        pool[root].quiet = quiet;
+        fill_children(pool[root], mtx, root_moves);
+
+        deadline = chrono::steady_clock::now() + chrono::milliseconds(time_ms);
+        done = 0;
+        pool_full = false;
+        stopped = false;
+        vector<thread> threads;
+        for (size_t t = 1; t < workers.size(); ++t)
+            threads.emplace_back(&Mcts::worker, this, t);
+        worker(0);
+        for (auto &th : threads)
+            th.join();
+
+        const mcts_node<G> &root_node = pool[root];
+        size_t best = 0;
+        for (size_t k = 1; k < root_node.num_children; ++k)
+        {
+            if (pool[root_node.first_child + k].visits > pool[root_node.first_child + best].visits)
+                best = k;
+        }
+        playouts = done;
+        span.set("playouts", (long long)playouts);
+        span.set("tree", (long long)pool.size());
+        logger().debug("mcts", "", {{"playouts", playouts}, {"tree", pool.size()}, {"threads", workers.size()}});
+        return root_moves[best];
+    }
+
+  private:
+    static void pack(const vector<vector<POS_T>> &mtx, mcts_node<G> &node)
+    {
+        for (POS_T i = 0; i < G::N; ++i)
+            for (POS_T j = (i + 1) % 2; j < G::N; j += 2)
+                node.cells[G::Tables.dark_index[i][j]] = mtx[i][j];
+    }
+
+    static void unpack(const mcts_node<G> &node, vector<vector<POS_T>> &mtx)
+    {
+        for (POS_T i = 0; i < G::N; ++i)
+            for (POS_T j = (i + 1) % 2; j < G::N; j += 2)
+                mtx[i][j] = node.cells[G::Tables.dark_index[i][j]];
+    }
+
+    // раскрытие узла ходами moves; без места в пуле узел остаётся листом
+    bool fill_children(mcts_node<G> &node, const vector<vector<POS_T>> &mtx, const vector<move_series> &moves)
+    {
+        uint32_t first = 0;
+        if (!moves.empty() && !pool.alloc(moves.size(), first))
+        {
+            pool_full = true;
+            node.state = 0;
+            return false;
+        }
+        for (size_t k = 0; k < moves.size(); ++k)
+        {
+            mcts_node<G> &child = pool[first + k];
+            pack(moves[k].position, child);
+            child.color = !node.color;
+            child.quiet = Logic<G>::next_quiet(mtx, moves[k], node.quiet);
+        }
+        node.first_child = first;
+        node.num_children = uint32_t(moves.size());
+        node.state.store(2, memory_order_release);
+        return true;
+    }
+
+    // UCT с учётом виртуальных поражений: непосещённые дети первыми
+    uint32_t select(const mcts_node<G> &node)
+    {
+        const double log_n = log(double(node.visits + node.virtual_loss) + 1);
+        uint32_t best = node.first_child;
+        double best_value = -1;
+        for (uint32_t k = node.first_child; k < node.first_child + node.num_children; ++k)
+        {
+            const mcts_node<G> &child = pool[k];
+            const uint32_t n = child.visits + child.virtual_loss;
+            if (n == 0)
+                return k;
+            const double value = child.score / (2.0 * n) + UctExploration * sqrt(log_n / n);
+            if (value > best_value)
+            {
+                best_value = value;
+                best = k;
+            }
+        }
+        return best;
+    }
+
+    bool should_stop() const
+    {
+        if (stopped)
+            return true;
+        if (max_playouts && done >= max_playouts)
+            return true;
+        return time_ms && chrono::steady_clock::now() >= deadline;
+    }
+
+    void worker(const size_t t)
+    {
+        Logic<G> &logic = *workers[t];
+        vector<uint32_t> path;
+        vector<vector<POS_T>> mtx(G::N, vector<POS_T>(G::N, 0));
+        while (!should_stop())
+        {
+            if (t == 0 && Yield_hook && !Yield_hook())
+            {
+                stopped = true;
+                break;
+            }
+            // спуск по дереву до нераскрытого узла
+            path.assign(1, root);
+            ++pool[root].virtual_loss;
+            uint32_t k = root;
+            while (pool[k].state.load(memory_order_acquire) == 2 && pool[k].num_children)
+            {
+                k = select(pool[k]);
+                ++pool[k].virtual_loss;
+                path.push_back(k);
+            }
+
+            // раскрытие листа, который уже посещали (один поток, остальные играют партию из листа)
+            mcts_node<G> &leaf = pool[k];
+            int expected = 0;
+            if (leaf.visits && !pool_full && leaf.state.compare_exchange_strong(expected, 1))
+            {
+                unpack(leaf, mtx);
+                const auto moves = logic.find_series(leaf.color, mtx);
+                if (fill_children(leaf, mtx, moves) && leaf.num_children)
+                {
+                    k = select(leaf);
+                    ++pool[k].virtual_loss;
+                    path.push_back(k);
+                }
+            }
+
+            const int winner = (pool[k].state.load(memory_order_acquire) == 2 && !pool[k].num_children)
+                                   ? int(!pool[k].color) // ходить нечем - выиграл соперник
+                                   : playout(pool[k], logic, rand_engs[t], mtx);
+
+            // обратный проход: очки за ход в узел получает сторона, которая его сделала
+            for (const uint32_t node_k : path)
+            {
+                mcts_node<G> &node = pool[node_k];
+                const int mover = !node.color;
+                node.score += winner == -1 ? 1 : (winner == mover ? 2 : 0);
+                ++node.visits;
+                --node.virtual_loss;
+            }
+            ++done;
+        }
+    }
+
+    // случайная партия из узла: 0 - выиграли белые, 1 - чёрные, -1 - ничья
+    int playout(const mcts_node<G> &node, Logic<G> &logic, default_random_engine &rand_eng,
+                vector<vector<POS_T>> &mtx)
+    {
+        unpack(node, mtx);
+        bool color = node.color;
+        int quiet = node.quiet;
+        for (int move_num = 0; move_num < PlayoutMoves; ++move_num)
+        {
+            if (no_progress_limit && quiet >= no_progress_limit)
+                return -1;
+            auto moves = logic.find_series(color, mtx);
+            if (moves.empty())
+                return !color;
+            auto &series = moves[rand_eng() % moves.size()];
+            quiet = Logic<G>::next_quiet(mtx, series, quiet);
+            mtx = move(series.position);
+            color = !color;
+        }
+        // партия не закончилась: решает соотношение сил (calc_score с true - чёрные к белым)
+        const double ratio = logic.calc_score(mtx, true);
+        if (ratio >= PlayoutWinRatio)
+            return 1;
+        if (ratio * PlayoutWinRatio <= 1)
+            return 0;
+        return -1;
+    }
+
+  private:
+    mcts_pool<G> pool;
+    vector<unique_ptr<Logic<G>>> workers;
+    // генераторы случайных партий, по одному на поток
+    vector<default_random_engine> rand_engs;
+    uint32_t root = 0;
+    const int time_ms;
+    const size_t max_playouts;
+    const int no_progress_limit;
+    chrono::steady_clock::time_point deadline;
+    atomic<size_t> done{0};
+    atomic<bool> pool_full{false};
+    atomic<bool> stopped{false}; // Yield_hook бросил поиск
+};
@@ -0,0 +1,592 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Logic.h"
+#include "MappedFile.h"
+
+using namespace std;
+
+// Партии в записи PDN (Portable Draughts Notation).
+// Русские шашки 8x8 - GameType 25, клетки алгебраические ("c3", белые внизу), взятие "c3:e5:g3".
+// Международные 10x10 - GameType 20, клетки - номера тёмных клеток 1..50 сверху слева, взятие "28x19x10".
+// При чтении принимаются оба вида клеток на обеих досках, ход сверяется с find_series: достаточно
+// начальной и конечной клетки, промежуточные клетки записи должны лежать на пути взятия по порядку
+
+// партия PDN: теги, начальная позиция, полные ходы с позициями после них и результат
+struct pdn_game
+{
+    vector<pair<string, string>> tags; // теги в порядке файла, кроме GameType, SetUp, FEN и Result
+    int board_size = 8;
+    vector<vector<POS_T>> start;       // начальная позиция (пусто - стандартная расстановка)
+    bool start_color = false;          // очередь хода в начальной позиции
+    vector<move_series> moves;
+    string result = "*";               // "1-0"/"2-0" - выиграли белые, "0-1"/"0-2" - чёрные, ничья, "*"
+    size_t offset = 0;                 // смещение партии в файле (при чтении)
+    string error;                      // пусто, если все ходы прошли проверку (при чтении)
+    size_t error_ply = 0;              // номер полухода с ошибкой, считая с 1
+};
+
+// итог чтения архива
+struct pdn_stats
+{
+    bool opened = false;
+    size_t games = 0;
+    size_t moves = 0;
+    size_t errors = 0; // партии с ошибкой разбора или недопустимым ходом
+};
+
+inline int pdn_game_type(const int n)
+{
+    return n == 10 ? 20 : 25;
+}
+
+// результат партии в записи варианта: 1 - выиграли белые, -1 - чёрные, 0 - ничья
+inline string pdn_result(const int n, const int winner)
+{
+    if (winner == 0)
+        return n == 10 ? "1-1" : "1/2-1/2";
+    if (winner > 0)
+        return n == 10 ? "2-0" : "1-0";
+    return n == 10 ? "0-2" : "0-1";
+}
+
+inline string pdn_square(const int n, const POS_T x, const POS_T y)
+{
+    if (n == 8)
+        return string(1, char('a' + y)) + to_string(n - x);
+    return to_string(x * n / 2 + y / 2 + 1);
+}
+
+// разбор клетки с позиции p; p сдвигается за клетку. false, если это не тёмная клетка доски n x n
+inline bool parse_pdn_square(const int n, const char *&p, const char *end, POS_T &x, POS_T &y)
+{
+    auto number = [&p, end]() {
+        int value = 0, digits = 0;
+        while (p < end && *p >= '0' && *p <= '9' && digits < 4)
+        {
+            value = value * 10 + (*p++ - '0');
+            ++digits;
+        }
+        return digits ? value : -1;
+    };
+    if (p < end && *p >= 'a' && *p < 'a' + n)
+    {
+        y = POS_T(*p++ - 'a');
+        const int rank = number();
+        if (rank < 1 || rank > n)
+            return false;
+        x = POS_T(n - rank);
+    }
+    else
+    {
+        const int square = number();
+        if (square < 1 || square > n * n / 2)
+            return false;
+        x = POS_T((square - 1) / (n / 2));
+        y = POS_T(2 * ((square - 1) % (n / 2)) + (x % 2 == 0));
+    }
+    return (x + y) % 2 == 1;
+}
+
+inline string pdn_move(const int n, const move_series &series)
+{
+    const string sep = series.captured ? (n == 8 ? ":" : "x") : "-";
+    string text = pdn_square(n, series.steps[0].x, series.steps[0].y);
+    for (const auto &step : series.steps)
+        text += sep + pdn_square(n, step.x2, step.y2);
+    return text;
+}
+
+// позиция в теге FEN: "W:Wa1,c1,Kd4:Bb8" (8x8) или "B:W31,32,K5:B1,2" (10x10)
+inline string pdn_fen(const vector<vector<POS_T>> &mtx, const bool color)
+{
+    const int n = int(mtx.size());
+    string side[2] = {"W", "B"};
+    for (POS_T i = 0; i < n; ++i)
+    {
+        for (POS_T j = 0; j < n; ++j)
+        {
+            if (!mtx[i][j])
+                continue;
+            string &list = side[(mtx[i][j] + 1) % 2];
+            list += (list.size() > 1 ? "," : "") + string(mtx[i][j] > 2 ? "K" : "") + pdn_square(n, i, j);
+        }
+    }
+    return string(color ? "B" : "W") + ":" + side[0] + ":" + side[1];
+}
+
+inline bool parse_pdn_fen(const string &fen, const int n, vector<vector<POS_T>> &mtx, bool &color)
+{
+    mtx.assign(n, vector<POS_T>(n, 0));
+    string text;
+    for (const char c : fen)
+    {
+        if (c != ' ' && c != '.' && c != '"')
+            text += c;
+    }
+    if (text.empty() || (text[0] != 'W' && text[0] != 'B'))
+        return false;
+    color = text[0] == 'B';
+    size_t pos = 1;
+    while (pos < text.size())
+    {
+        if (text[pos] != ':' || pos + 1 >= text.size() || (text[pos + 1] != 'W' && text[pos + 1] != 'B'))
+            return false;
+        const POS_T man = text[pos + 1] == 'W' ? 1 : 2;
+        const char *p = text.data() + pos + 2;
+        const char *end = text.data() + text.size();
+        while (p < end && *p != ':')
+        {
+            const bool king = *p == 'K';
+            p += king;
+            POS_T x, y;
+            if (!parse_pdn_square(n, p, end, x, y))
+                return false;
+            POS_T x2 = x, y2 = y;
+            // диапазон номеров "1-12"
+            if (p < end && *p == '-' && !parse_pdn_square(n, ++p, end, x2, y2))
+                return false;
+            for (int square = x * n / 2 + y / 2; square <= x2 * n / 2 + y2 / 2; ++square)
+            {
+                const POS_T i = POS_T(square / (n / 2));
+                mtx[i][2 * (square % (n / 2)) + (i % 2 == 0)] = POS_T(man + 2 * king);
+            }
+            if (p < end && *p == ',')
+                ++p;
+        }
+        pos = size_t(p - text.data());
+    }
+    return true;
+}
+
+// полные ходы партии по истории позиций, где серия взятий записана по шагам (Board::history_mtx):
+// позиция, в которую не ведёт ни один полный ход, - промежуточная позиция серии
+template <class G>
+vector<move_series> moves_from_history(Logic<G> &logic, const vector<vector<vector<POS_T>>> &history, bool color = false)
+{
+    vector<move_series> moves;
+    if (history.empty())
+        return moves;
+    vector<vector<POS_T>> mtx = history[0];
+    for (size_t k = 1; k < history.size(); ++k)
+    {
+        for (auto &series : logic.find_series(color, mtx))
+        {
+            if (series.position == history[k])
+            {
+                moves.push_back(move(series));
+                mtx = history[k];
+                color = !color;
+                break;
+            }
+        }
+    }
+    return moves;
+}
+
+inline void write_pdn(ostream &out, const pdn_game &game)
+{
+    auto tag = [&out](const string &name, const string &value) {
+        string escaped;
+        for (const char c : value)
+            escaped += (c == '"' || c == '\\') ? string("\\") + c : string(1, c);
+        out << "[" << name << " \"" << escaped << "\"]\n";
+    };
+    for (const auto &t : game.tags)
+        tag(t.first, t.second);
+    tag("GameType", to_string(pdn_game_type(game.board_size)));
+    if (!game.start.empty())
+    {
+        tag("SetUp", "1");
+        tag("FEN", pdn_fen(game.start, game.start_color));
+    }
+    tag("Result", game.result);
+    out << "\n";
+
+    // ходы строками не длиннее 80 символов
+    string line;
+    auto put = [&out, &line](const string &token) {
+        if (!line.empty() && line.size() + 1 + token.size() > 80)
+        {
+            out << line << "\n";
+            line.clear();
+        }
+        line += (line.empty() ? "" : " ") + token;
+    };
+    for (size_t k = 0; k < game.moves.size(); ++k)
+    {
+        const size_t ply = k + game.start_color;
+        if (ply % 2 == 0)
+            put(to_string(ply / 2 + 1) + ".");
+        else if (k == 0)
+            put(to_string(ply / 2 + 1) + "...");
+        put(pdn_move(game.board_size, game.moves[k]));
+    }
+    put(game.result);
+    out << line << "\n\n";
+}
+
+// дописывает партию в конец файла архива
+inline bool append_pdn(const string &path, const pdn_game &game)
+{
+    ofstream fout(path, ios::app);
+    if (!fout)
+        return false;
+    write_pdn(fout, game);
+    return bool(fout);
+}
+
+// дата для тега Date: "2024.05.17"
+inline string pdn_date()
+{
+    const time_t now = time(nullptr);
+    char buf[16];
+    strftime(buf, sizeof(buf), "%Y.%m.%d", localtime(&now));
+    return buf;
+}
+
+// маркер результата партии в записи ходов
+inline bool is_pdn_result(const string &text)
+{
+    return text == "*" || text == "1-0" || text == "0-1" || text == "2-0" || text == "0-2" || text == "1-1" ||
+           text == "0-0" || text == "1/2-1/2";
+}
+
+// начало партии: строка тегов ('['), перед которой нет строки тегов, или запись ходов без тегов (цифра номера
+// хода) в начале файла или после строки, которая кончается результатом. Поиск с позиции p; end, если партий
+// дальше нет
+inline const char *next_pdn_game(const char *p, const char *begin, const char *end)
+{
+    for (; p < end; ++p)
+    {
+        if ((*p != '[' && (*p < '0' || *p > '9')) || (p != begin && p[-1] != '\n'))
+            continue;
+        const char *q = p;
+        while (q > begin && (q[-1] == '\n' || q[-1] == '\r' || q[-1] == ' ' || q[-1] == '\t'))
+            --q;
+        if (q == begin)
+            return p;
+        // начало предыдущей непустой строки
+        const char *line = q;
+        while (line > begin && line[-1] != '\n')
+            --line;
+        while (line < q && (*line == ' ' || *line == '\t'))
+            ++line;
+        if (*p == '[' && *line != '[')
+            return p;
+        if (*p != '[')
+        {
+            const char *token = q;
+            while (token > line && token[-1] != ' ' && token[-1] != '\t')
+                --token;
+            if (is_pdn_result(string(token, q)))
+                return p;
+        }
+    }
+    return end;
+}
+
+// разбор тегов партии [p, end); p сдвигается на начало записи ходов
+inline void parse_pdn_tags(const char *&p, const char *end, pdn_game &game, string &game_type, string &fen)
+{
+    auto skip_space = [&p, end]() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+            ++p;
+    };
+    skip_space();
+    while (p < end && *p == '[')
+    {
+        ++p;
+        string name, value;
+        while (p < end && *p != ' ' && *p != '"' && *p != ']')
+            name += *p++;
+        while (p < end && *p != '"' && *p != ']')
+            ++p;
+        if (p < end && *p == '"')
+        {
+            for (++p; p < end && *p != '"'; ++p)
+            {
+                if (*p == '\\' && p + 1 < end)
+                    ++p;
+                value += *p;
+            }
+        }
+        while (p < end && *p != ']' && *p != '\n')
+            ++p;
+        if (p < end && *p == ']')
+            ++p;
+        if (name == "GameType")
+            game_type = value;
+        else if (name == "FEN")
+            fen = value;
+        else if (name == "Result")
+            game.result = value;
+        else if (name != "SetUp")
+            game.tags.emplace_back(name, value);
+        skip_space();
+    }
+}
+
+// проверка записи ходов [p, end) по правилам варианта G: ходы разбираются, пока не встретится
+// результат, конец партии или ошибка. Комментарии {...} и ;..., варианты (...) и оценки $N пропускаются
+template <class G> void replay_pdn_moves(Logic<G> &logic, const char *p, const char *end, pdn_game &game)
+{
+    const int n = G::N;
+    vector<vector<POS_T>> mtx = game.start.empty() ? start_position(n) : game.start;
+    bool color = game.start_color;
+    auto fail = [&game](const string &error) {
+        game.error = error;
+        game.error_ply = game.moves.size() + 1;
+    };
+    vector<pair<POS_T, POS_T>> squares;
+    while (p < end)
+    {
+        const char c = *p;
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+        {
+            ++p;
+            continue;
+        }
+        if (c == '{' || c == ';')
+        {
+            const char close = c == '{' ? '}' : '\n';
+            while (p < end && *p != close)
+                ++p;
+            ++p;
+            continue;
+        }
+        if (c == '(')
+        {
+            int level = 0;
+            do
+            {
+                level += (*p == '(') - (*p == ')');
+                ++p;
+            } while (p < end && level > 0);
+            continue;
+        }
+        const char *token = p;
+        while (p < end && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r' && *p != '{' && *p != '(' &&
+               *p != ';')
+            ++p;
+        string text(token, p);
+        if (text[0] == '$')
+            continue;
+        if (is_pdn_result(text))
+        {
+            game.result = text;
+            return;
+        }
+        // номер хода "12." или "12..." перед ходом или слитно с ним
+        size_t digits = 0;
+        while (digits < text.size() && text[digits] >= '0' && text[digits] <= '9')
+            ++digits;
+        if (digits && digits < text.size() && text[digits] == '.')
+        {
+            text.erase(0, text.find_first_not_of('.', digits));
+            if (text.find_first_not_of('.') == string::npos)
+                continue;
+        }
+        // пометки хода ("!", "?", "+") после клеток не нужны
+        text.erase(text.find_last_not_of("!?+#") + 1);
+
+        squares.clear();
+        const char *q = text.data(), *q_end = text.data() + text.size();
+        bool ok = true;
+        while (ok && q < q_end)
+        {
+            POS_T x, y;
+            ok = parse_pdn_square(n, q, q_end, x, y);
+            squares.emplace_back(x, y);
+            if (ok && q < q_end)
+            {
+                ok = *q == '-' || *q == 'x' || *q == ':';
+                ++q;
+            }
+        }
+        if (!ok || squares.size() < 2)
+            return fail("bad move '" + text + "'");
+
+        // тихий ход (большинство ходов партии) сверяется с одиночными ходами find_turns:
+        // полные серии нужны, только когда есть взятие
+        logic.find_turns(color, mtx);
+        if (!logic.have_beats)
+        {
+            const auto turn = find(logic.turns.begin(), logic.turns.end(),
+                                   move_pos(squares[0].first, squares[0].second, squares[1].first, squares[1].second));
+            if (squares.size() != 2 || turn == logic.turns.end())
+                return fail("illegal move '" + text + "'");
+            move_series series;
+            series.steps.push_back(*turn);
+            series.position = logic.make_turn(mtx, *turn);
+            mtx = series.position;
+            game.moves.push_back(move(series));
+            color = !color;
+            continue;
+        }
+
+        // ход записи - полный ход с той же начальной и конечной клеткой, через все промежуточные клетки.
+        // Запись всего пути выбирает ход среди более длинных серий через те же клетки
+        auto candidates = logic.find_series(color, mtx, false);
+        const move_series *found = nullptr;
+        bool found_exact = false, ambiguous = false;
+        for (const auto &series : candidates)
+        {
+            const auto &first = series.steps.front(), &last = series.steps.back();
+            if (first.x != squares[0].first || first.y != squares[0].second || last.x2 != squares.back().first ||
+                last.y2 != squares.back().second)
+                continue;
+            size_t k = 1;
+            for (size_t s = 0; s + 1 < series.steps.size(); ++s)
+            {
+                if (k + 1 < squares.size() && series.steps[s].x2 == squares[k].first &&
+                    series.steps[s].y2 == squares[k].second)
+                    ++k;
+            }
+            if (k + 1 != squares.size())
+                continue;
+            const bool exact = series.steps.size() + 1 == squares.size();
+            if (found && exact == found_exact)
+            {
+                ambiguous = ambiguous || found->position != series.position;
+                continue;
+            }
+            if (found && found_exact)
+                continue;
+            found = &series;
+            found_exact = exact;
+            ambiguous = false;
+        }
+        if (ambiguous)
+            return fail("ambiguous move '" + text + "'");
+        if (!found)
+            return fail("illegal move '" + text + "'");
+        mtx = found->position;
+        game.moves.push_back(*found);
+        color = !color;
+    }
+}
+
+// первый символ первой клетки в записи ходов или FEN: буква - алгебраическая запись, цифра - номера.
+// Номера ходов ("12.") и комментарии пропускаются
+inline char first_pdn_square(const char *p, const char *end)
+{
+    for (; p < end; ++p)
+    {
+        if (*p == '{')
+        {
+            while (p < end && *p != '}')
+                ++p;
+            continue;
+        }
+        if (*p >= 'a' && *p <= 'j')
+            return *p;
+        if (*p >= '0' && *p <= '9')
+        {
+            const char *q = p;
+            while (q < end && *q >= '0' && *q <= '9')
+                ++q;
+            if (q == end || *q != '.')
+                return *p;
+            p = q;
+        }
+    }
+    return '1';
+}
+
+// разбор одной партии [begin, end). Без тега GameType вариант определяется по записи клеток:
+// алгебраическая - русские шашки, номера - международные
+inline void parse_pdn_game(Logic<geometry<8>> &logic8, Logic<geometry<10>> &logic10, const char *begin,
+                           const char *end, pdn_game &game)
+{
+    const char *p = begin;
+    string game_type, fen;
+    parse_pdn_tags(p, end, game, game_type, fen);
+    if (game_type.empty())
+    {
+        const char first = fen.empty() ? first_pdn_square(p, end) : first_pdn_square(fen.data(), fen.data() + fen.size());
+        game.board_size = (first >= 'a' && first <= 'j') ? 8 : 10;
+    }
+    else if (game_type == "20" || game_type.compare(0, 3, "20,") == 0)
+        game.board_size = 10;
+    else if (game_type == "25" || game_type.compare(0, 3, "25,") == 0)
+        game.board_size = 8;
+    else
+    {
+        game.error = "unsupported GameType " + game_type;
+        return;
+    }
+    if (!fen.empty() && !parse_pdn_fen(fen, game.board_size, game.start, game.start_color))
+    {
+        game.error = "bad FEN";
+        return;
+    }
+    if (game.board_size == 10)
+        replay_pdn_moves(logic10, p, end, game);
+    else
+        replay_pdn_moves(logic8, p, end, game);
+}
+
+// Чтение архива PDN: файл отображается в память и делится на куски по границам партий, куски
+// разбирают threads потоков, у каждого свои движки. on_game(pdn_game &) вызывается из потоков
+// одновременно, партии внутри куска - по порядку файла
+template <class F> pdn_stats read_pdn(const string &path, const int threads, F on_game)
+{
+    pdn_stats stats;
+    mapped_file file(path);
+    stats.opened = file.is_open();
+    if (!file.size())
+        return stats;
+    const char *begin = file.data(), *end = begin + file.size();
+
+    // кусков больше, чем потоков: поток, закончивший раньше, берёт следующий
+    const int workers = max(1, threads);
+    const size_t chunk = max<size_t>(size_t(1) << 20, file.size() / (size_t(workers) * 16) + 1);
+    vector<const char *> bounds = {next_pdn_game(begin, begin, end)};
+    while (bounds.back() < end)
+    {
+        const char *next = bounds.back() + chunk < end ? next_pdn_game(bounds.back() + chunk, begin, end) : end;
+        bounds.push_back(next);
+    }
+
+    atomic<size_t> next_chunk{0}, games{0}, moves{0}, errors{0};
+    auto worker = [&]() {
+        engine_settings settings;
+        settings.no_random = true;
+        Logic<geometry<8>> logic8(settings);
+        Logic<geometry<10>> logic10(settings);
+        size_t k;
+        while ((k = next_chunk++) + 1 < bounds.size())
+        {
+            for (const char *game_begin = bounds[k]; game_begin < bounds[k + 1];)
+            {
+                const char *game_end = next_pdn_game(game_begin + 1, begin, bounds[k + 1]);
+                pdn_game game;
+                game.offset = size_t(game_begin - begin);
+                parse_pdn_game(logic8, logic10, game_begin, game_end, game);
+                ++games;
+                moves += game.moves.size();
+                errors += !game.error.empty();
+                on_game(game);
+                game_begin = game_end;
+            }
+        }
+    };
+    vector<thread> pool;
+    for (int t = 1; t < workers; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &th : pool)
+        th.join();
+    stats.games = games;
+    stats.moves = moves;
+    stats.errors = errors;
+    return stats;
+}
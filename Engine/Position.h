@@ -0,0 +1,122 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "../Models/Move.h"
+
+using namespace std;
+
+// стартовая расстановка на доске n x n: чёрные шашки (2) в верхних (n - 2) / 2 рядах, белые (1) в нижних
+inline vector<vector<POS_T>> start_position(const int n = 8)
+{
+    const int rows = (n - 2) / 2;
+    vector<vector<POS_T>> mtx(n, vector<POS_T>(n, 0));
+    for (POS_T i = 0; i < n; ++i)
+    {
+        for (POS_T j = 0; j < n; ++j)
+        {
+            if (i < rows && (i + j) % 2 == 1)
+                mtx[i][j] = 2;
+            if (i >= n - rows && (i + j) % 2 == 1)
+                mtx[i][j] = 1;
+        }
+    }
+    return mtx;
+}
+
+// текстовая запись позиции по строкам сверху вниз: '.' - пусто, w/b - шашки, W/B - дамки белых/чёрных.
+// Размер доски - число строк
+const string PieceChars = ".wbWB";
+
+inline vector<vector<POS_T>> parse_position(const vector<string> &rows)
+{
+    const POS_T n = POS_T(rows.size());
+    vector<vector<POS_T>> mtx(n, vector<POS_T>(n, 0));
+    for (POS_T i = 0; i < n; ++i)
+    {
+        for (POS_T j = 0; j < n; ++j)
+        {
+            const auto piece = PieceChars.find(rows[i][j]);
+            mtx[i][j] = POS_T(piece == string::npos ? 0 : piece);
+        }
+    }
+    return mtx;
+}
+
+// число фигур обоих цветов
+inline int count_pieces(const vector<vector<POS_T>> &mtx)
+{
+    int res = 0;
+    for (const auto &row : mtx)
+        for (const POS_T cell : row)
+            res += cell != 0;
+    return res;
+}
+
+inline vector<string> position_rows(const vector<vector<POS_T>> &mtx)
+{
+    const POS_T n = POS_T(mtx.size());
+    vector<string> rows(n, string(n, '.'));
+    for (POS_T i = 0; i < n; ++i)
+        for (POS_T j = 0; j < n; ++j)
+            rows[i][j] = PieceChars[mtx[i][j]];
+    return rows;
+}
+
+// позиция одной строкой для файлов позиций: ряды сверху вниз через '/', пробел и очередь хода (w или b).
+// Например, начальная позиция 8x8: ".b.b.b.b/b.b.b.b./.b.b.b.b/......../......../w.w.w.w./.w.w.w.w/w.w.w.w. w"
+inline string position_line(const vector<vector<POS_T>> &mtx, const bool color)
+{
+    string line;
+    for (const auto &row : position_rows(mtx))
+        line += (line.empty() ? "" : "/") + row;
+    return line + (color ? " b" : " w");
+}
+
+// разбор строки position_line; false, если строка не задаёт позицию 8x8 или 10x10 с фигурами на тёмных клетках
+inline bool parse_position_line(const string &line, vector<vector<POS_T>> &mtx, bool &color)
+{
+    const auto space = line.find(' ');
+    const string board = line.substr(0, space);
+    const string side = space == string::npos ? "w" : line.substr(space + 1, 1);
+    if (side != "w" && side != "b")
+        return false;
+    vector<string> rows(1);
+    for (const char c : board)
+    {
+        if (c == '/')
+            rows.emplace_back();
+        else
+            rows.back() += c;
+    }
+    const size_t n = rows.size();
+    if (n != 8 && n != 10)
+        return false;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (rows[i].size() != n)
+            return false;
+        for (size_t j = 0; j < n; ++j)
+        {
+            const auto piece = PieceChars.find(rows[i][j]);
+            if (piece == string::npos || (piece && (i + j) % 2 == 0))
+                return false;
+        }
+    }
+    mtx = parse_position(rows);
+    color = side == "b";
+    return true;
+}
+
+// запись полного хода клетками пути "ряд,столбец": тихий ход "5,0-4,1", серия взятий "5,0-3,2-1,4"
+inline string series_text(const move_series &series)
+{
+    string text;
+    for (const auto &step : series.steps)
+    {
+        if (text.empty())
+            text = to_string(step.x) + "," + to_string(step.y);
+        text += "-" + to_string(step.x2) + "," + to_string(step.y2);
+    }
+    return text;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <chrono>
+
+#include "Logic.h"
+
+// итог партии бот против бота
+struct game_result
+{
+    int winner = -1;              // 0 - белые, 1 - чёрные, -1 - ничья
+    int turns = 0;                // число сделанных ходов
+    size_t nodes[2] = {0, 0};     // узлы поиска каждой стороны
+    double ms[2] = {0, 0};        // время поиска каждой стороны
+    int searches[2] = {0, 0};     // число поисков каждой стороны
+};
+
+// партия без графики по правилам Game::play: players[0] играет белыми, players[1] - чёрными
+template <class G> game_result play_game(Logic<G> *players[2], const int max_turns, const int no_progress_limit)
+{
+    game_result res;
+    auto mtx = start_position(G::N);
+    vector<vector<vector<POS_T>>> history = {mtx};
+    int turn_num = -1;
+    while (++turn_num < max_turns)
+    {
+        Logic<G> &logic = *players[turn_num % 2];
+        logic.find_turns(turn_num % 2, mtx);
+        if (logic.turns.empty())
+        {
+            // ход за стороной без ходов - она проиграла
+            res.winner = 1 - turn_num % 2;
+            break;
+        }
+        logic.set_history(history, turn_num % 2);
+        if (no_progress_limit && logic.history_quiet_plies() >= no_progress_limit)
+            break;
+        auto start = chrono::steady_clock::now();
+        mtx = logic.find_best_turns(turn_num % 2, mtx).position;
+        auto end = chrono::steady_clock::now();
+        res.ms[turn_num % 2] += chrono::duration<double, milli>(end - start).count();
+        res.nodes[turn_num % 2] += logic.nodes;
+        ++res.searches[turn_num % 2];
+        history.push_back(mtx);
+    }
+    res.turns = turn_num;
+    return res;
+}
+
+// итог серии партий бот против бота
+struct selfplay_result
+{
+    int white_wins = 0;
+    int black_wins = 0;
+    int draws = 0;
+    size_t nodes = 0;
+    double ms = 0;
+};
+
+// партии бот против бота без графики: фиксированная нагрузка для профилирования (PGO) и замера узлов в секунду.
+// Генератор случайных чисел зависит только от номера партии, поэтому нагрузка воспроизводима
+template <class G = geometry<8>>
+selfplay_result selfplay(const engine_settings &settings, const int games, const int depth, const int max_turns)
+{
+    Logic<G> logic(settings);
+    logic.Max_depth = depth;
+    Logic<G> *players[2] = {&logic, &logic};
+    selfplay_result res;
+    for (int game = 0; game < games; ++game)
+    {
+        logic.seed(game);
+        auto game_res = play_game(players, max_turns, settings.no_progress_limit);
+        if (game_res.winner == 0)
+            ++res.white_wins;
+        else if (game_res.winner == 1)
+            ++res.black_wins;
+        else
+            ++res.draws;
+        res.nodes += game_res.nodes[0] + game_res.nodes[1];
+        res.ms += game_res.ms[0] + game_res.ms[1];
+    }
+    return res;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+
+using namespace std;
+
+// настройки движка, которые раньше Logic читал из settings.json сам.
+// Движок не зависит от nlohmann/json: структуру заполняет Config (игра) или инструмент командной строки
+struct engine_settings
+{
+    string scoring_mode = "NumberAndPotential"; // "NumberOnly" или "NumberAndPotential"
+    string optimization = "O1";                 // "O0", "O1" или "O2"
+    bool no_random = false;                     // детерминированный выбор среди равных ходов
+    int no_progress_limit = 30;                 // ходов дамками без взятий до ничьей (0 - без ограничения)
+    string engine = "AlphaBeta";                // "AlphaBeta" (минимакс), "MCTS" или "Distributed"
+    int threads = 1;                            // потоки поиска MCTS
+    int mcts_time_ms = 1000;                    // время MCTS на ход (0 - без ограничения)
+    size_t mcts_playouts = 0;                   // предел случайных партий MCTS на ход (0 - без ограничения)
+    int mcts_memory_mb = 64;                    // размер пула узлов дерева MCTS
+    int solver_pieces = 0;                      // решатель df-pn при стольких фигурах и меньше (0 - выключен)
+    size_t solver_nodes = 200000;               // предел узлов решателя на одно доказательство
+    int solver_memory_mb = 16;                  // размер таблицы доказательств
+    size_t multi_pv = 1;                        // ходов корня, среди которых выбирает temperature
+    double temperature = 0;                     // температура выбора хода (0 - всегда лучший)
+    string workers = "";                        // адреса воркеров распределённого поиска через запятую
+    int worker_timeout_ms = 10000;              // воркер без ответа дольше этого считается потерянным
+    int distributed_time_ms = 60000;            // предел распределённого поиска, остаток считается на месте
+    string experience_file = "";                // хранилище опыта поисков ("" - выключено)
+    size_t experience_mb = 64;                  // предел размера хранилища, дальше - сжатие
+};
@@ -0,0 +1,195 @@
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "../Models/Move.h"
+
+using namespace std;
+
+// снимок партии: по нему игра продолжается с того же места после перезапуска
+struct game_snapshot
+{
+    int board_size = 8;
+    int turn_num = 0;                        // номер хода, с которого продолжается партия (чётный - белые)
+    vector<vector<vector<POS_T>>> history;   // позиции партии, последняя - текущая
+    vector<int> beat_series;                 // метки серий взятий, как Board::history_beat_series
+};
+
+// Формат файла снимка (little-endian):
+//   "CKSN", версия u32, размер доски u32, номер хода u32, число позиций u32,
+//   затем для каждой позиции N*N/2 байт фигур на тёмных клетках и метка серии u32
+const char SnapshotMagic[4] = {'C', 'K', 'S', 'N'};
+const uint32_t SnapshotVersion = 1;
+
+// запись через временный файл: данные сбрасываются на диск, затем rename атомарно заменяет прошлый
+// снимок, так что сбой в любой момент оставляет старый или новый снимок целиком
+inline bool save_snapshot(const string &path, const game_snapshot &snap)
+{
+    const int n = snap.board_size;
+    vector<uint8_t> buf(SnapshotMagic, SnapshotMagic + 4);
+    auto put = [&buf](const uint32_t value) {
+        for (int k = 0; k < 4; ++k)
+            buf.push_back(uint8_t(value >> (8 * k)));
+    };
+    put(SnapshotVersion);
+    put(uint32_t(n));
+    put(uint32_t(snap.turn_num));
+    put(uint32_t(snap.history.size()));
+    for (size_t k = 0; k < snap.history.size(); ++k)
+    {
+        for (int i = 0; i < n; ++i)
+            for (int j = (i + 1) % 2; j < n; j += 2)
+                buf.push_back(uint8_t(snap.history[k][i][j]));
+        put(uint32_t(k < snap.beat_series.size() ? snap.beat_series[k] : 0));
+    }
+
+    const string tmp_path = path + ".tmp";
+    FILE *f = fopen(tmp_path.c_str(), "wb");
+    if (!f)
+        return false;
+    bool ok = fwrite(buf.data(), 1, buf.size(), f) == buf.size() && fflush(f) == 0;
+#ifndef _WIN32
+    ok = ok && fsync(fileno(f)) == 0;
+#endif
+    if (fclose(f) != 0 || !ok)
+    {
+        remove(tmp_path.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    remove(path.c_str()); // rename на Windows не заменяет существующий файл
+#endif
+    return rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+inline bool load_snapshot(const string &path, game_snapshot &snap)
+{
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    vector<uint8_t> buf;
+    uint8_t chunk[1 << 16];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), f)) > 0)
+        buf.insert(buf.end(), chunk, chunk + got);
+    fclose(f);
+
+    size_t pos = 0;
+    auto get = [&buf, &pos](uint32_t &value) {
+        if (pos + 4 > buf.size())
+            return false;
+        value = 0;
+        for (int k = 0; k < 4; ++k)
+            value |= uint32_t(buf[pos++]) << (8 * k);
+        return true;
+    };
+    if (buf.size() < 4 || memcmp(buf.data(), SnapshotMagic, 4) != 0)
+        return false;
+    pos = 4;
+    uint32_t version, n, turn_num, count;
+    if (!get(version) || version != SnapshotVersion || !get(n) || (n != 8 && n != 10) || !get(turn_num) ||
+        !get(count))
+        return false;
+    if (buf.size() - pos != size_t(count) * (n * n / 2 + 4) || count == 0)
+        return false;
+
+    snap.board_size = int(n);
+    snap.turn_num = int(turn_num);
+    snap.history.assign(count, vector<vector<POS_T>>(n, vector<POS_T>(n, 0)));
+    snap.beat_series.assign(count, 0);
+    for (uint32_t k = 0; k < count; ++k)
+    {
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            for (uint32_t j = (i + 1) % 2; j < n; j += 2)
+            {
+                if (buf[pos] > 4)
+                    return false;
+                snap.history[k][i][j] = POS_T(buf[pos++]);
+            }
+        }
+        uint32_t series;
+        get(series);
+        snap.beat_series[k] = int(series);
+    }
+    return true;
+}
+
+// дамп таблицы движка (массив записей фиксированного размера) через отображение файла в память.
+// Первые 8 байт - метка tag (формат записей, размер, ключи хэширования): чужой дамп не загрузится.
+// На Windows - обычный файловый ввод-вывод
+inline bool save_table_dump(const string &path, const uint64_t tag, const void *data, const size_t bytes)
+{
+    const size_t total = sizeof(tag) + bytes;
+#ifndef _WIN32
+    const string tmp_path = path + ".tmp";
+    const int fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+    bool ok = ftruncate(fd, off_t(total)) == 0;
+    void *dst = ok ? mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ok = dst != MAP_FAILED;
+    if (ok)
+    {
+        memcpy(dst, &tag, sizeof(tag));
+        memcpy(static_cast<char *>(dst) + sizeof(tag), data, bytes);
+        ok = munmap(dst, total) == 0;
+    }
+    ok = ok && fsync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    if (!ok)
+    {
+        unlink(tmp_path.c_str());
+        return false;
+    }
+    return rename(tmp_path.c_str(), path.c_str()) == 0;
+#else
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+    const bool ok = fwrite(&tag, sizeof(tag), 1, f) == 1 && fwrite(data, 1, bytes, f) == bytes;
+    return fclose(f) == 0 && ok;
+#endif
+}
+
+// загрузка дампа: метка и размер файла должны совпадать с таблицей
+inline bool load_table_dump(const string &path, const uint64_t tag, void *data, const size_t bytes)
+{
+    const size_t total = sizeof(tag) + bytes;
+#ifndef _WIN32
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 && size_t(st.st_size) == total;
+    void *src = ok ? mmap(nullptr, total, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    ok = src != MAP_FAILED && memcmp(src, &tag, sizeof(tag)) == 0;
+    if (ok)
+        memcpy(data, static_cast<const char *>(src) + sizeof(tag), bytes);
+    if (src != MAP_FAILED)
+        munmap(src, total);
+    close(fd);
+    return ok;
+#else
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    fseek(f, 0, SEEK_END);
+    bool ok = size_t(ftell(f)) == total;
+    fseek(f, 0, SEEK_SET);
+    uint64_t file_tag = 0;
+    ok = ok && fread(&file_tag, sizeof(file_tag), 1, f) == 1 && file_tag == tag;
+    ok = ok && fread(data, 1, bytes, f) == bytes;
+    fclose(f);
+    return ok;
+#endif
+}
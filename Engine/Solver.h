@@ -0,0 +1,275 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "Hash.h"
+#include "Log.h"
+#include "Settings.h"
+#include "Snapshot.h"
+
+using namespace std;
+
+template <class G> class Logic;
+
+// параметры решателя
+const uint32_t PnInf = 1u << 30;                       // бесконечное число доказательства
+const int SolverMaxPlies = 200;                        // глубже решатель считает позицию недоказанной
+const uint64_t AttackerSalt = 0x5DEECE66DA3B9F17ull;   // ключи таблицы разные для двух сторон-атакующих
+const uint64_t QuietSalt = 0x9E3779B97F4A7C15ull;      // ключ зависит от числа ходов дамками без взятий
+const uint64_t SolverTableVersion = 3;                 // версия ключей и записей в дампе таблицы
+
+// запись таблицы доказательств: числа (phi, delta) для стороны на ходу
+struct pn_entry
+{
+    uint64_t key = 0;
+    uint32_t phi = 0;
+    uint32_t delta = 0;
+};
+
+// итог решения позиции
+struct solve_result
+{
+    int result = 0;   // 1 - сторона на ходу выигрывает, -1 - проигрывает, 0 - не доказано
+    move_series best; // выигрывающий ход при result == 1
+    size_t nodes = 0;
+    double ms = 0;
+};
+
+// Решатель df-pn (поиск по числам доказательства в глубину, Nagai) над полными ходами.
+// В записи phi/delta числа хранятся для стороны на ходу: phi = 0 - сторона на ходу выигрывает,
+// delta = 0 - не выигрывает. Ничья (повтор, серия ходов дамками, предел глубины) - неудача атакующего,
+// поэтому выигрыш и проигрыш доказываются отдельными поисками с разными атакующими.
+// Таблица - хэш-таблица фиксированного размера с заменой, переживает вызовы solve
+template <class G> class PnSolver
+{
+  public:
+    PnSolver(const engine_settings &settings)
+        : max_nodes(settings.solver_nodes), no_progress_limit(settings.no_progress_limit)
+    {
+        engine_settings worker_settings = settings;
+        worker_settings.engine = "AlphaBeta";
+        worker_settings.solver_pieces = 0;
+        worker_settings.experience_file = "";
+        worker_settings.no_random = true;
+        logic = make_unique<Logic<G>>(worker_settings);
+        size_t entries = 1;
+        while (entries * 2 * sizeof(pn_entry) <= size_t(max(1, settings.solver_memory_mb)) << 20)
+            entries *= 2;
+        table.assign(entries, pn_entry());
+    }
+
+    // доказательство выигрыша стороны color в позиции mtx, при prove_loss - и проигрыша.
+    // quiet - ходов дамками без взятий перед позицией
+    solve_result solve(const bool color, const vector<vector<POS_T>> &mtx, const int quiet, const bool prove_loss = true)
+    {
+        trace_span span("solve");
+        auto start = chrono::steady_clock::now();
+        solve_result res;
+        nodes = 0;
+        stopped = false;
+        yield_at = Yield_hook && Yield_nodes ? Yield_nodes : numeric_limits<size_t>::max();
+        const auto root_moves = logic->find_series(color, mtx);
+        if (root_moves.empty())
+        {
+            res.result = -1;
+        }
+        else if (run(color, color, mtx, quiet).first == 0)
+        {
+            res.result = 1;
+            res.best = move(root_best);
+        }
+        else if (prove_loss && !stopped && run(!color, color, mtx, quiet).second == 0)
+        {
+            res.result = -1;
+        }
+        res.nodes = nodes;
+        res.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        span.set("result", res.result);
+        span.set("nodes", (long long)res.nodes);
+        logger().debug("solver", "", {{"result", res.result}, {"nodes", res.nodes}, {"ms", res.ms}});
+        return res;
+    }
+
+    // дамп таблицы доказательств: после перезапуска уже доказанные позиции не ищутся заново
+    bool save_table(const string &path) const
+    {
+        return save_table_dump(path, table_tag(), table.data(), table.size() * sizeof(pn_entry));
+    }
+
+    bool load_table(const string &path)
+    {
+        return load_table_dump(path, table_tag(), table.data(), table.size() * sizeof(pn_entry));
+    }
+
+    // кооперативный режим, как у Logic: каждые Yield_nodes узлов решатель вызывает Yield_hook в том же
+    // потоке. Hook вернул false - решение бросается, позиция остаётся недоказанной
+    function<bool()> Yield_hook;
+    size_t Yield_nodes = 0;
+
+  private:
+    // метка формата таблицы: размер доски и записей, число записей, ключи Зобриста
+    uint64_t table_tag() const
+    {
+        return zobrist().piece[1][0][1] ^ zobrist().black_to_move ^ AttackerSalt ^
+               (uint64_t(G::N) << 56) ^ (uint64_t(sizeof(pn_entry)) << 48) ^ (SolverTableVersion << 40) ^
+               uint64_t(table.size());
+    }
+
+    // корневой вызов для атакующего attacker, возвращает (phi, delta) корня
+    pair<uint32_t, uint32_t> run(const bool attacker_color, const bool color, const vector<vector<POS_T>> &mtx,
+                                 const int quiet)
+    {
+        attacker = attacker_color;
+        budget = nodes + max_nodes;
+        path.clear();
+        uint32_t phi = 0, delta = 0;
+        mid(mtx, color, quiet, 0, PnInf, PnInf, phi, delta);
+        return {phi, delta};
+    }
+
+    // ничья - выигрыш защищающегося
+    void draw_value(const bool color, uint32_t &phi, uint32_t &delta) const
+    {
+        phi = color == attacker ? PnInf : 0;
+        delta = color == attacker ? 0 : PnInf;
+    }
+
+    // ключ позиции для атакующего attacker. Ничья по серии ходов дамками зависит от quiet, поэтому
+    // доказательство при короткой серии не годится для той же позиции при длинной
+    uint64_t key(const uint64_t hash, const int quiet) const
+    {
+        const uint64_t k = hash ^ uint64_t(quiet) * QuietSalt;
+        return attacker ? k ^ AttackerSalt : k;
+    }
+
+    bool lookup(const uint64_t k, uint32_t &phi, uint32_t &delta) const
+    {
+        const pn_entry &e = table[k & (table.size() - 1)];
+        if (e.key != k)
+            return false;
+        phi = e.phi;
+        delta = e.delta;
+        return true;
+    }
+
+    void store(const uint64_t k, const uint32_t phi, const uint32_t delta)
+    {
+        pn_entry &e = table[k & (table.size() - 1)];
+        e.key = k;
+        e.phi = phi;
+        e.delta = delta;
+    }
+
+    // повтор позиции на пути с той же очередью хода внутри серии ходов дамками
+    bool is_repetition(const int quiet) const
+    {
+        const int size = int(path.size());
+        for (int k = size - 3; k >= 0 && k >= size - 1 - quiet; k -= 2)
+        {
+            if (path[k] == path.back())
+                return true;
+        }
+        return false;
+    }
+
+    // раскрытие узла, пока его числа не превысят пороги (tphi, tdelta). Возвращает true, если числа узла
+    // зависят от ничьей по пути (повтор, предел ходов дамками или глубины): такое доказательство или
+    // опровержение верно только для этого пути и в таблицу не пишется (взаимодействие графа и истории)
+    bool mid(const vector<vector<POS_T>> &mtx, const bool color, const int quiet, const int ply, const uint32_t tphi,
+             const uint32_t tdelta, uint32_t &phi, uint32_t &delta)
+    {
+        ++nodes;
+        if (nodes >= yield_at)
+        {
+            yield_at = nodes + Yield_nodes;
+            stopped = stopped || !Yield_hook();
+        }
+        const uint64_t hash = position_hash(mtx, color);
+        path.push_back(hash);
+        // ничьи зависят от пути, в таблицу не пишутся
+        if ((no_progress_limit && quiet >= no_progress_limit) || ply >= SolverMaxPlies || is_repetition(quiet))
+        {
+            draw_value(color, phi, delta);
+            path.pop_back();
+            return true;
+        }
+        const uint64_t k = key(hash, quiet);
+        auto moves = logic->find_series(color, mtx);
+        if (moves.empty())
+        {
+            // ходить нечем - сторона на ходу проиграла
+            phi = PnInf;
+            delta = 0;
+            store(k, phi, delta);
+            path.pop_back();
+            return false;
+        }
+
+        vector<uint32_t> child_phi(moves.size(), 1), child_delta(moves.size(), 1);
+        vector<int> child_quiet(moves.size());
+        for (size_t c = 0; c < moves.size(); ++c)
+        {
+            child_quiet[c] = Logic<G>::next_quiet(mtx, moves[c], quiet);
+            lookup(key(position_hash(moves[c].position, !color), child_quiet[c]), child_phi[c], child_delta[c]);
+        }
+        size_t best = 0;
+        bool path_dependent = false;
+        while (true)
+        {
+            // phi - минимум delta детей, delta - сумма phi детей
+            best = 0;
+            uint32_t delta2 = PnInf;
+            phi = PnInf;
+            delta = 0;
+            for (size_t c = 0; c < moves.size(); ++c)
+            {
+                if (child_delta[c] < phi)
+                {
+                    delta2 = phi;
+                    phi = child_delta[c];
+                    best = c;
+                }
+                else if (child_delta[c] < delta2)
+                {
+                    delta2 = child_delta[c];
+                }
+                delta = min(PnInf, delta + child_phi[c]);
+            }
+            if (phi >= tphi || delta >= tdelta || nodes >= budget || stopped)
+                break;
+            const uint32_t next_tphi = min<uint64_t>(PnInf, uint64_t(tdelta) - delta + child_phi[best]);
+            const uint32_t next_tdelta = min(tphi, delta2 + 1);
+            path_dependent = mid(moves[best].position, !color, child_quiet[best], ply + 1, next_tphi, next_tdelta,
+                                 child_phi[best], child_delta[best]) ||
+                             path_dependent;
+        }
+        if (ply == 0)
+            root_best = move(moves[best]);
+        // недоказанные числа только направляют поиск, их можно хранить и при зависимости от пути
+        if (!path_dependent || (phi && delta))
+            store(k, phi, delta);
+        path.pop_back();
+        return path_dependent;
+    }
+
+  private:
+    unique_ptr<Logic<G>> logic;
+    vector<pn_entry> table;
+    const size_t max_nodes;
+    const int no_progress_limit;
+    bool attacker = false;
+    size_t nodes = 0;
+    size_t budget = 0;
+    // счётчик nodes, на котором снова вызывается Yield_hook, и признак брошенного решения
+    size_t yield_at = numeric_limits<size_t>::max();
+    bool stopped = false;
+    // лучший ход корня после последнего поиска
+    move_series root_best;
+    // хэши позиций от корня до текущего узла
+    vector<uint64_t> path;
+};
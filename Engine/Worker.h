@@ -0,0 +1,270 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Logic.h"
+
+using namespace std;
+
+// задание, полученное воркером от координатора
+struct worker_job
+{
+    uint32_t search_id = 0;
+    uint32_t job_id = 0;
+    bool color = false;
+    int depth = 0;
+    double alpha = -1;
+    double beta = OpenBound;
+    vector<uint64_t> history;
+    vector<vector<POS_T>> mtx;
+    vector<vector<uint8_t>> line; // ходы от корня в номерах тёмных клеток
+};
+
+// Воркер распределённого поиска: слушает address и обслуживает координаторов по одному.
+// Поток чтения принимает сообщения и складывает задания в очередь, поток поиска считает их по порядку.
+// ALPHA поднимает общую границу, которую поиск читает на ходу; STOP снимает задания законченного поиска
+template <class G> class search_worker
+{
+  public:
+    explicit search_worker(const wire_connection &conn) : conn(conn)
+    {
+    }
+
+    // настройки из сообщения CONFIG, прочитанного до выбора размера доски
+    void configure(const vector<uint8_t> &payload)
+    {
+        handle(WireMessage::CONFIG, payload);
+    }
+
+    // обслуживает соединение, пока координатор его не закроет
+    void serve()
+    {
+        thread searcher(&search_worker::search_loop, this);
+        WireMessage type;
+        vector<uint8_t> payload;
+        do
+        {
+            // в буфере могут остаться сообщения, пришедшие вместе с CONFIG
+            while (conn.next(type, payload))
+                handle(type, payload);
+        } while (conn.receive() && !conn.broken());
+        {
+            lock_guard<mutex> lock(mtx);
+            closed = true;
+            jobs.clear();
+            abort_search();
+        }
+        ready.notify_all();
+        searcher.join();
+    }
+
+  private:
+    void handle(const WireMessage type, const vector<uint8_t> &payload)
+    {
+        wire_reader r(payload.data(), payload.data() + payload.size());
+        lock_guard<mutex> lock(mtx);
+        if (type == WireMessage::CONFIG)
+        {
+            const int size = int(r.get(1));
+            const uint64_t scoring = r.get(1), optimization = r.get(1);
+            settings.no_progress_limit = int(r.get(2));
+            settings.scoring_mode = scoring == 0 ? "NumberOnly" : "NumberAndPotential";
+            settings.optimization = optimization == 0 ? "O0" : (optimization == 2 ? "O2" : "O1");
+            settings.no_random = true;
+            configured = r.ok && size == G::N;
+            if (!configured)
+                logger().warning("worker", "unsupported config", {{"size", size}});
+            ready.notify_all();
+        }
+        else if (type == WireMessage::JOB)
+        {
+            worker_job job;
+            job.search_id = uint32_t(r.get(4));
+            job.job_id = uint32_t(r.get(4));
+            job.color = r.get(1) != 0;
+            job.depth = int(r.get(1));
+            job.history.resize(r.get(2));
+            for (auto &hash : job.history)
+                hash = r.get(8);
+            job.mtx = r.get_position(G::N);
+            job.alpha = r.get_double();
+            job.beta = r.get_double();
+            job.line.resize(r.get(1));
+            for (auto &path : job.line)
+                path = r.get_path();
+            if (!r.ok || job.line.empty())
+                return;
+            // задание нового поиска: задания прошлого больше никому не нужны
+            if (job.search_id != search_id)
+            {
+                search_id = job.search_id;
+                shared_alpha.store(job.alpha);
+            }
+            jobs.push_back(move(job));
+            ready.notify_all();
+        }
+        else if (type == WireMessage::ALPHA)
+        {
+            const uint32_t id = uint32_t(r.get(4));
+            const double alpha = r.get_double();
+            if (r.ok && id == search_id)
+                raise_alpha(alpha);
+        }
+        else if (type == WireMessage::STOP)
+        {
+            const uint32_t id = uint32_t(r.get(4));
+            if (r.ok && id == search_id)
+            {
+                jobs.clear();
+                abort_search();
+            }
+        }
+    }
+
+    void raise_alpha(const double alpha)
+    {
+        double current = shared_alpha.load();
+        while (alpha > current && !shared_alpha.compare_exchange_weak(current, alpha))
+        {
+        }
+    }
+
+    // граница выше любой оценки: текущий поиск отсекается в каждом узле и быстро возвращается
+    void abort_search()
+    {
+        raise_alpha(OpenBound);
+    }
+
+    void search_loop()
+    {
+        unique_ptr<Logic<G>> logic;
+        while (true)
+        {
+            worker_job job;
+            {
+                unique_lock<mutex> lock(mtx);
+                ready.wait(lock, [this]() { return closed || (configured && !jobs.empty()); });
+                if (closed)
+                    return;
+                job = move(jobs.front());
+                jobs.pop_front();
+                if (!logic)
+                {
+                    logic = make_unique<Logic<G>>(settings);
+                    logic->Shared_alpha = &shared_alpha;
+                }
+            }
+            vector<move_series> line;
+            if (!decode_line(*logic, job, line))
+            {
+                logger().warning("worker", "illegal line", {{"job", job.job_id}});
+                continue;
+            }
+            logic->Max_depth = job.depth;
+            logic->set_history_hashes(job.history);
+            const double alpha = max(job.alpha, shared_alpha.load());
+            const double score = logic->search_line(job.color, job.mtx, line, alpha, job.beta);
+            wire_writer result(WireMessage::RESULT);
+            result.put(job.search_id, 4);
+            result.put(job.job_id, 4);
+            result.put_double(score);
+            result.put(logic->nodes, 8);
+            lock_guard<mutex> lock(mtx);
+            // снятое задание: оценка после обрыва ничего не значит
+            if (job.search_id == search_id && shared_alpha.load() < OpenBound)
+                conn.send(result.finish());
+        }
+    }
+
+    // ходы задания: каждый путь ищется среди полных ходов позиции, так ход получает и взятые фигуры
+    static bool decode_line(Logic<G> &logic, const worker_job &job, vector<move_series> &line)
+    {
+        const vector<vector<POS_T>> *position = &job.mtx;
+        bool color = job.color;
+        for (const auto &path : job.line)
+        {
+            bool found = false;
+            for (auto &series : logic.find_series(color, *position, false))
+            {
+                if (series_path(series, G::N) == path)
+                {
+                    line.push_back(move(series));
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+                return false;
+            position = &line.back().position;
+            color = !color;
+        }
+        return true;
+    }
+
+    wire_connection conn;
+    engine_settings settings;
+    bool configured = false;
+    bool closed = false;
+    uint32_t search_id = 0;
+    atomic<double> shared_alpha{-1};
+    deque<worker_job> jobs;
+    mutex mtx;
+    condition_variable ready;
+};
+
+// одно соединение координатора: размер доски приходит в CONFIG, первое сообщение читается здесь,
+// дальше - воркером нужного размера
+inline void serve_coordinator(const int fd)
+{
+    wire_connection conn(fd);
+    WireMessage type;
+    vector<uint8_t> payload;
+    bool got = false;
+    while (!got && conn.receive() && !conn.broken())
+        got = conn.next(type, payload);
+    if (got && type == WireMessage::CONFIG && !payload.empty())
+    {
+        logger().info("worker", "coordinator connected", {{"size", int(payload[0])}});
+        if (payload[0] == 10)
+        {
+            search_worker<geometry<10>> worker(conn);
+            worker.configure(payload);
+            worker.serve();
+        }
+        else
+        {
+            search_worker<geometry<8>> worker(conn);
+            worker.configure(payload);
+            worker.serve();
+        }
+    }
+    conn.close_socket();
+    logger().info("worker", "coordinator disconnected");
+}
+
+// воркер на адресе address; возвращает false, если адрес не удалось открыть.
+// Каждый координатор обслуживается своим потоком: у партии бот против бота их два, и второй не ждёт первого
+inline bool run_worker(const string &address)
+{
+#ifndef _WIN32
+    const int listener = open_socket(address, true);
+    if (listener < 0)
+        return false;
+    logger().info("worker", "listening", {{"address", address}});
+    while (true)
+    {
+        const int fd = accept(listener, nullptr, nullptr);
+        if (fd >= 0)
+            thread(serve_coordinator, fd).detach();
+    }
+#else
+    (void)address;
+    return false;
+#endif
+}
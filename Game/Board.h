@@ -1,9 +1,12 @@
 #pragma once 
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include "nlohmann/json.hpp" 
 
+#include "../Engine/Log.h"
+#include "../Engine/Position.h"
 #include "../Models/Move.h"
 #include "../Models/Project_path.h"
 
@@ -19,15 +22,26 @@ using namespace std;
 
 class Board
 {
+    // спрайт: текстура и область на ней (весь атлас или отдельный файл)
+    struct sprite
+    {
+        SDL_Texture *tex = nullptr;
+        SDL_Rect src{0, 0, 0, 0};
+    };
+
 public:
     Board() = default;
-    Board(const unsigned int W, const unsigned int H) : W(W), H(H)
+    // N - число клеток по стороне доски (8 или 10)
+    Board(const unsigned int W, const unsigned int H, const int N = 8)
+        : W(W), H(H), N(N), drawn_mtx(N, vector<POS_T>(N, 0)), is_highlighted_(N, vector<bool>(N, 0)),
+          mtx(N, vector<POS_T>(N, 0))
     {
     }
 
     // инициализация и отображение стартовой доски
     int start_draw()
     {
+        auto start = chrono::steady_clock::now();
         if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
         {
             print_exception("SDL_Init can't init SDL2 lib");
@@ -51,20 +65,16 @@ public:
             print_exception("SDL_CreateWindow can't create window");
             return 1;
         }
-        ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC |
+                                          SDL_RENDERER_TARGETTEXTURE);
         if (ren == nullptr)
         {
             print_exception("SDL_CreateRenderer can't create renderer");
             return 1;
         }
-        board = IMG_LoadTexture(ren, board_path.c_str());
-        w_piece = IMG_LoadTexture(ren, piece_white_path.c_str());
-        b_piece = IMG_LoadTexture(ren, piece_black_path.c_str());
-        w_queen = IMG_LoadTexture(ren, queen_white_path.c_str());
-        b_queen = IMG_LoadTexture(ren, queen_black_path.c_str());
-        back = IMG_LoadTexture(ren, back_path.c_str());
-        replay = IMG_LoadTexture(ren, replay_path.c_str());
-        if (!board || !w_piece || !b_piece || !w_queen || !b_queen || !back || !replay)
+        // атлас декодируется и загружается на GPU одним вызовом, отдельные файлы - запасной вариант
+        const bool from_atlas = load_atlas();
+        if (!from_atlas && !load_textures())
         {
             print_exception("IMG_LoadTexture can't load main textures from " + textures_path);
             return 1;
@@ -72,6 +82,9 @@ public:
         SDL_GetRendererOutputSize(ren, &W, &H);
         make_start_mtx();
         rerender();
+        auto end = chrono::steady_clock::now();
+        logger().info("startup", "", {{"ms", (int)chrono::duration<double, milli>(end - start).count()},
+                                      {"textures", from_atlas ? "atlas" : "separate"}});
         return 0;
     }
 
@@ -86,18 +99,19 @@ public:
         clear_highlight();
     }
 
-    // перемещение фигуры на новую позицию
-    void move_piece(move_pos turn, const int beat_series = 0)
+    // перемещение фигуры на новую позицию; promote = false - шаг серии взятий без превращения в дамку
+    void move_piece(move_pos turn, const int beat_series = 0, const bool promote = true)
     {
         if (turn.xb != -1)
         {
             mtx[turn.xb][turn.yb] = 0;
         }
-        move_piece(turn.x, turn.y, turn.x2, turn.y2, beat_series);
+        move_piece(turn.x, turn.y, turn.x2, turn.y2, beat_series, promote);
     }
 
     // обработка перемещения фигуры, включая превращение в дамку
-    void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0)
+    void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0,
+                    const bool promote = true)
     {
         if (mtx[i2][j2])
         {
@@ -107,7 +121,7 @@ public:
         {
             throw runtime_error("begin position is empty, can't move");
         }
-        if ((mtx[i][j] == 1 && i2 == 0) || (mtx[i][j] == 2 && i2 == 7))
+        if (promote && ((mtx[i][j] == 1 && i2 == 0) || (mtx[i][j] == 2 && i2 == N - 1)))
             mtx[i][j] += 2;
         mtx[i2][j2] = mtx[i][j];
         drop_piece(i, j);
@@ -138,6 +152,22 @@ public:
         return mtx;
     }
 
+    // метки серий взятий для каждой позиции истории
+    vector<int> get_beat_series() const
+    {
+        return history_beat_series;
+    }
+
+    // восстановление партии из снимка: история позиций с метками серий, текущая - последняя
+    void restore(const vector<vector<vector<POS_T>>> &history, const vector<int> &beat_series)
+    {
+        history_mtx = history;
+        history_beat_series = beat_series;
+        mtx = history_mtx.back();
+        clear_active();
+        clear_highlight();
+    }
+
     // выделение клеток на доске
     void highlight_cells(vector<pair<POS_T, POS_T>> cells)
     {
@@ -152,9 +182,9 @@ public:
     // очистка всех выделений
     void clear_highlight()
     {
-        for (POS_T i = 0; i < 8; ++i)
+        for (POS_T i = 0; i < N; ++i)
         {
-            is_highlighted_[i].assign(8, 0);
+            is_highlighted_[i].assign(N, 0);
         }
         rerender();
     }
@@ -199,6 +229,7 @@ public:
     void show_final(const int res)
     {
         game_results = res;
+        result_texture(res);
         rerender();
     }
 
@@ -206,19 +237,77 @@ public:
     void reset_window_size()
     {
         SDL_GetRendererOutputSize(ren, &W, &H);
+        reset_layers();
+    }
+
+    // пересоздание кэшированных слоёв (смена размера или потеря render target'ов драйвером)
+    void reset_layers()
+    {
+        layers_dirty = true;
         rerender();
     }
 
+    // повторный вывод кадра без изменений (окно было перекрыто)
+    void repaint()
+    {
+        rerender();
+    }
+
+    // вывод кадра, если с прошлого вывода что-то изменилось.
+    // Вызывается один раз за итерацию цикла событий, поэтому несколько изменений доски дают один present
+    void flush()
+    {
+        if (!frame_dirty || !ren)
+            return;
+        trace_span span("render");
+        frame_dirty = false;
+        if (layers_dirty)
+            rebuild_layers();
+        update_piece_layer();
+
+        SDL_SetRenderTarget(ren, nullptr);
+        SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
+        SDL_RenderClear(ren);
+        if (static_layer)
+            SDL_RenderCopy(ren, static_layer, nullptr, nullptr);
+        else
+            draw_static();
+        if (piece_layer)
+        {
+            SDL_RenderCopy(ren, piece_layer, nullptr, nullptr);
+        }
+        else
+        {
+            for (POS_T i = 0; i < N; ++i)
+                for (POS_T j = 0; j < N; ++j)
+                    draw_piece(i, j);
+        }
+        draw_highlight();
+        if (game_results != -1)
+        {
+            SDL_Rect dst{W / 5, H * 3 / 10, W * 3 / 5, H * 2 / 5};
+            SDL_RenderCopy(ren, result_texture(game_results), nullptr, &dst);
+        }
+        SDL_RenderPresent(ren);
+    }
+
     // завершение работы и очистка ресурсов
     void quit()
     {
-        SDL_DestroyTexture(board);
-        SDL_DestroyTexture(w_piece);
-        SDL_DestroyTexture(b_piece);
-        SDL_DestroyTexture(w_queen);
-        SDL_DestroyTexture(b_queen);
-        SDL_DestroyTexture(back);
-        SDL_DestroyTexture(replay);
+        if (atlas)
+        {
+            SDL_DestroyTexture(atlas);
+        }
+        else
+        {
+            for (auto &s : main_sprites())
+                SDL_DestroyTexture(s.second->tex);
+        }
+        SDL_DestroyTexture(white_wins);
+        SDL_DestroyTexture(black_wins);
+        SDL_DestroyTexture(draw_res);
+        SDL_DestroyTexture(static_layer);
+        SDL_DestroyTexture(piece_layer);
         SDL_DestroyRenderer(ren);
         SDL_DestroyWindow(win);
         SDL_Quit();
@@ -241,62 +330,301 @@ private:
     // создание стартовой матрицы доски
     void make_start_mtx()
     {
-        for (POS_T i = 0; i < 8; ++i)
+        mtx = start_position(N);
+        add_history();
+    }
+
+    // список основных спрайтов с их именами в индексе атласа
+    vector<pair<string, sprite *>> main_sprites()
+    {
+        return {{"board", &board},     {"piece_white", &w_piece}, {"piece_black", &b_piece},
+                {"queen_white", &w_queen}, {"queen_black", &b_queen}, {"back", &back},
+                {"replay", &replay}};
+    }
+
+    // загрузка основных спрайтов из атласа, собранного Tools/pack_atlas.cpp
+    bool load_atlas()
+    {
+        ifstream fin(atlas_index_path);
+        if (!fin.is_open())
+            return false;
+        atlas = IMG_LoadTexture(ren, atlas_path.c_str());
+        if (!atlas)
+            return false;
+        auto sprites = main_sprites();
+        string name;
+        SDL_Rect src;
+        while (fin >> name >> src.x >> src.y >> src.w >> src.h)
         {
-            for (POS_T j = 0; j < 8; ++j)
+            for (auto &s : sprites)
             {
-                mtx[i][j] = 0;
-                if (i < 3 && (i + j) % 2 == 1)
-                    mtx[i][j] = 2;
-                if (i > 4 && (i + j) % 2 == 1)
-                    mtx[i][j] = 1;
+                if (s.first == name)
+                    *s.second = {atlas, src};
             }
         }
-        add_history();
+        fin.close();
+        for (auto &s : sprites)
+        {
+            if (!s.second->tex)
+            {
+                // индекс не соответствует атласу, переходим на отдельные файлы
+                for (auto &s2 : sprites)
+                    *s2.second = sprite();
+                SDL_DestroyTexture(atlas);
+                atlas = nullptr;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // загрузка основных спрайтов из отдельных файлов
+    bool load_textures()
+    {
+        bool ok = true;
+        for (auto &s : main_sprites())
+        {
+            s.second->tex = IMG_LoadTexture(ren, (textures_path + s.first + ".png").c_str());
+            s.second->src = {0, 0, 0, 0};
+            if (s.second->tex)
+                SDL_QueryTexture(s.second->tex, nullptr, nullptr, &s.second->src.w, &s.second->src.h);
+            ok = ok && s.second->tex;
+        }
+        return ok;
     }
 
-    // перерисовка текстур на экране
+    // текстура итогового экрана, загружается при первом показе результата
+    SDL_Texture *result_texture(const int res)
+    {
+        SDL_Texture **tex = &draw_res;
+        string path = draw_path;
+        if (res == 1)
+        {
+            tex = &white_wins;
+            path = white_path;
+        }
+        else if (res == 2)
+        {
+            tex = &black_wins;
+            path = black_path;
+        }
+        if (!*tex)
+        {
+            *tex = IMG_LoadTexture(ren, path.c_str());
+            if (!*tex)
+                print_exception("IMG_LoadTexture can't load result texture " + path);
+        }
+        return *tex;
+    }
+
+    // пометка кадра как изменённого, сам вывод делает flush
     void rerender()
     {
-        // реализация отрисовки текстур
+        frame_dirty = true;
+    }
+
+    // область клетки на экране: доска занимает сетку (N + 2) x (N + 2) с рамкой в одну клетку
+    SDL_Rect cell_rect(const POS_T i, const POS_T j) const
+    {
+        return {W * (j + 1) / (N + 2), H * (i + 1) / (N + 2), W * (j + 2) / (N + 2) - W * (j + 1) / (N + 2),
+                H * (i + 2) / (N + 2) - H * (i + 1) / (N + 2)};
+    }
+
+    // статичная часть кадра: доска и кнопки
+    void draw_static()
+    {
+        SDL_RenderCopy(ren, board.tex, &board.src, nullptr);
+        // текстура доски нарисована под 8x8, клетки других размеров рисуем поверх её рамки
+        if (N != 8)
+        {
+            for (POS_T i = 0; i < N; ++i)
+            {
+                for (POS_T j = 0; j < N; ++j)
+                {
+                    SDL_Rect cell = cell_rect(i, j);
+                    if ((i + j) % 2)
+                        SDL_SetRenderDrawColor(ren, 120, 72, 40, 255);
+                    else
+                        SDL_SetRenderDrawColor(ren, 238, 214, 176, 255);
+                    SDL_RenderFillRect(ren, &cell);
+                }
+            }
+        }
+        SDL_Rect back_dst{W / 40, H / 40, W / 15, H / 15};
+        SDL_RenderCopy(ren, back.tex, &back.src, &back_dst);
+        SDL_Rect replay_dst{W * 109 / 120, H / 40, W / 15, H / 15};
+        SDL_RenderCopy(ren, replay.tex, &replay.src, &replay_dst);
+    }
+
+    // отрисовка фигуры в клетке (i, j) в текущий render target
+    void draw_piece(const POS_T i, const POS_T j, const SDL_BlendMode mode = SDL_BLENDMODE_BLEND)
+    {
+        const sprite *piece = nullptr;
+        switch (mtx[i][j])
+        {
+        case 1:
+            piece = &w_piece;
+            break;
+        case 2:
+            piece = &b_piece;
+            break;
+        case 3:
+            piece = &w_queen;
+            break;
+        case 4:
+            piece = &b_queen;
+            break;
+        default:
+            return;
+        }
+        // фигура занимает 5/6 клетки по центру
+        const SDL_Rect cell = cell_rect(i, j);
+        SDL_Rect dst{cell.x + cell.w / 12, cell.y + cell.h / 12, cell.w * 5 / 6, cell.h * 5 / 6};
+        SDL_SetTextureBlendMode(piece->tex, mode);
+        SDL_RenderCopy(ren, piece->tex, &piece->src, &dst);
+        SDL_SetTextureBlendMode(piece->tex, SDL_BLENDMODE_BLEND);
+    }
+
+    // оверлей подсветки и активной клетки, рисуется поверх слоёв каждый кадр
+    void draw_highlight()
+    {
+        const int thickness = max(1, W / 300);
+        SDL_SetRenderDrawColor(ren, 0, 255, 0, 255);
+        for (POS_T i = 0; i < N; ++i)
+        {
+            for (POS_T j = 0; j < N; ++j)
+            {
+                if (is_highlighted_[i][j])
+                    draw_frame(cell_rect(i, j), thickness);
+            }
+        }
+        if (active_x != -1)
+        {
+            SDL_SetRenderDrawColor(ren, 255, 0, 0, 255);
+            draw_frame(cell_rect(active_x, active_y), thickness);
+        }
+    }
+
+    // рамка заданной толщины внутри прямоугольника
+    void draw_frame(SDL_Rect rect, const int thickness)
+    {
+        for (int k = 0; k < thickness; ++k)
+        {
+            SDL_RenderDrawRect(ren, &rect);
+            ++rect.x;
+            ++rect.y;
+            rect.w -= 2;
+            rect.h -= 2;
+        }
+    }
+
+    // создание кэшированных слоёв под текущий размер окна.
+    // Если драйвер не поддерживает render target'ы, слои остаются пустыми и кадр рисуется напрямую
+    void rebuild_layers()
+    {
+        layers_dirty = false;
+        SDL_DestroyTexture(static_layer);
+        SDL_DestroyTexture(piece_layer);
+        static_layer = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, W, H);
+        piece_layer = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, W, H);
+        if (!static_layer || !piece_layer || SDL_SetRenderTarget(ren, static_layer) != 0)
+        {
+            SDL_DestroyTexture(static_layer);
+            SDL_DestroyTexture(piece_layer);
+            static_layer = nullptr;
+            piece_layer = nullptr;
+            SDL_SetRenderTarget(ren, nullptr);
+            return;
+        }
+        SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
+        SDL_RenderClear(ren);
+        draw_static();
+
+        SDL_SetTextureBlendMode(piece_layer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderTarget(ren, piece_layer);
+        SDL_SetRenderDrawColor(ren, 0, 0, 0, 0);
+        SDL_RenderClear(ren);
+        SDL_SetRenderTarget(ren, nullptr);
+        // слой фигур пуст, все занятые клетки будут нарисованы заново
+        for (auto &row : drawn_mtx)
+            row.assign(N, 0);
+    }
+
+    // перерисовка в слое фигур только тех клеток, которые изменились с прошлого кадра
+    void update_piece_layer()
+    {
+        if (!piece_layer)
+            return;
+        bool target_set = false;
+        for (POS_T i = 0; i < N; ++i)
+        {
+            for (POS_T j = 0; j < N; ++j)
+            {
+                if (drawn_mtx[i][j] == mtx[i][j])
+                    continue;
+                if (!target_set)
+                {
+                    SDL_SetRenderTarget(ren, piece_layer);
+                    target_set = true;
+                }
+                // стираем клетку до прозрачности и копируем фигуру без смешивания с пустым слоем
+                SDL_Rect cell = cell_rect(i, j);
+                SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
+                SDL_SetRenderDrawColor(ren, 0, 0, 0, 0);
+                SDL_RenderFillRect(ren, &cell);
+                draw_piece(i, j, SDL_BLENDMODE_NONE);
+                drawn_mtx[i][j] = mtx[i][j];
+            }
+        }
+        if (target_set)
+            SDL_SetRenderTarget(ren, nullptr);
     }
 
     // запись ошибки в лог-файл
     void print_exception(const string& text) {
-        ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Error: " << text << ". "<< SDL_GetError() << endl;
-        fout.close();
+        logger().error("sdl", text + ". " + SDL_GetError());
     }
 
 public:
     int W = 0;
     int H = 0;
+    // число клеток по стороне доски
+    int N = 8;
     // история состояний доски
     vector<vector<vector<POS_T>>> history_mtx;
 
 private:
     SDL_Window *win = nullptr;
     SDL_Renderer *ren = nullptr;
-    // текстуры
-    SDL_Texture *board = nullptr;
-    SDL_Texture *w_piece = nullptr;
-    SDL_Texture *b_piece = nullptr;
-    SDL_Texture *w_queen = nullptr;
-    SDL_Texture *b_queen = nullptr;
-    SDL_Texture *back = nullptr;
-    SDL_Texture *replay = nullptr;
+    // общий атлас основных спрайтов
+    SDL_Texture *atlas = nullptr;
+    // основные спрайты
+    sprite board;
+    sprite w_piece;
+    sprite b_piece;
+    sprite w_queen;
+    sprite b_queen;
+    sprite back;
+    sprite replay;
+    // кэшированные слои: доска с кнопками и фигуры
+    SDL_Texture *static_layer = nullptr;
+    SDL_Texture *piece_layer = nullptr;
+    // состояние доски, нарисованное в слое фигур
+    vector<vector<POS_T>> drawn_mtx = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
+    // флаги: кадр изменился, слои нужно пересоздать
+    bool frame_dirty = true;
+    bool layers_dirty = true;
+    // текстуры итоговых экранов (ленивая загрузка)
+    SDL_Texture *white_wins = nullptr;
+    SDL_Texture *black_wins = nullptr;
+    SDL_Texture *draw_res = nullptr;
     // пути к текстурам
     const string textures_path = project_path + "Textures/";
-    const string board_path = textures_path + "board.png";
-    const string piece_white_path = textures_path + "piece_white.png";
-    const string piece_black_path = textures_path + "piece_black.png";
-    const string queen_white_path = textures_path + "queen_white.png";
-    const string queen_black_path = textures_path + "queen_black.png";
+    const string atlas_path = textures_path + "atlas.png";
+    const string atlas_index_path = textures_path + "atlas.txt";
     const string white_path = textures_path + "white_wins.png";
     const string black_path = textures_path + "black_wins.png";
     const string draw_path = textures_path + "draw.png";
-    const string back_path = textures_path + "back.png";
-    const string replay_path = textures_path + "replay.png";
     // координаты выбранной клетки
     int active_x = -1, active_y = -1;
     // результат игры
@@ -4,6 +4,8 @@
 using json = nlohmann::json;
 using namespace std;
 #include "../Models/Project_path.h"
+#include "../Engine/Log.h"
+#include "../Engine/Settings.h"
 
 class Config
 {
@@ -26,6 +28,88 @@ class Config
         return config[setting_dir][setting_name];
     }
 
+    // минимальный уровень записей в log.txt из раздела "Log"
+    LogLevel log_level() const
+    {
+        const string level = config["Log"]["Level"];
+        if (level == "DEBUG")
+            return LogLevel::DEBUG;
+        if (level == "WARNING")
+            return LogLevel::WARNING;
+        if (level == "ERROR")
+            return LogLevel::ERROR;
+        return LogLevel::INFO;
+    }
+
+    // размер доски из раздела "Game": 10 - международные шашки, иначе русские 8x8
+    int board_size() const
+    {
+        return config.value("Game", json::object()).value("BoardSize", 8) == 10 ? 10 : 8;
+    }
+
+    // настройки движка стороны color (false - белые, true - чёрные) из раздела "Bot": общий ключ, например
+    // "Optimization", можно переопределить для стороны ключом "WhiteBotOptimization" / "BlackBotOptimization"
+    // ("BotScoringType" - "WhiteBotScoringType"). Ключа нет в старом settings.json - значение по умолчанию
+    // из engine_settings
+    engine_settings bot_settings(const bool color) const
+    {
+        const json bot = config.value("Bot", json::object());
+        const json game = config.value("Game", json::object());
+        const string side = color ? "Black" : "White";
+        auto side_key = [&side](const string &key) {
+            return side + (key.compare(0, 3, "Bot") == 0 ? key : "Bot" + key);
+        };
+        auto get = [&bot, &side_key](const string &key, const auto fallback) {
+            return bot.contains(side_key(key)) ? bot[side_key(key)].get<decltype(fallback)>() : bot.value(key, fallback);
+        };
+        engine_settings settings;
+        settings.scoring_mode = get("BotScoringType", settings.scoring_mode);
+        settings.optimization = get("Optimization", settings.optimization);
+        settings.no_random = bot.value("NoRandom", settings.no_random);
+        settings.no_progress_limit = game.value("NoProgressLimit", settings.no_progress_limit);
+        settings.engine = get("Engine", settings.engine);
+        settings.threads = get("Threads", settings.threads);
+        settings.mcts_time_ms = get("MCTSTimeMS", settings.mcts_time_ms);
+        settings.mcts_memory_mb = get("MCTSMemoryMB", settings.mcts_memory_mb);
+        settings.solver_pieces = get("SolverPieces", settings.solver_pieces);
+        settings.solver_nodes = get("SolverNodes", settings.solver_nodes);
+        settings.solver_memory_mb = get("SolverMemoryMB", settings.solver_memory_mb);
+        settings.multi_pv = get("MultiPV", settings.multi_pv);
+        settings.temperature = bot.value(side + "BotTemperature", settings.temperature);
+        settings.workers = bot.value("Workers", settings.workers);
+        settings.worker_timeout_ms = bot.value("WorkerTimeoutMS", settings.worker_timeout_ms);
+        settings.distributed_time_ms = bot.value("DistributedTimeMS", settings.distributed_time_ms);
+        const string experience = bot.value("ExperienceFile", settings.experience_file);
+        settings.experience_file = experience.empty() ? "" : project_path + experience;
+        settings.experience_mb = bot.value("ExperienceMB", settings.experience_mb);
+        return settings;
+    }
+
+    // бюджет кадра интерфейса в миллисекундах
+    int frame_ms() const
+    {
+        return config.value("WindowSize", json::object()).value("FrameMS", 16);
+    }
+
+    // узлов поиска между квантами планировщика (0 - поиск не отдаёт поток до конца расчёта)
+    size_t yield_nodes() const
+    {
+        return config.value("Bot", json::object()).value("YieldNodes", size_t(2048));
+    }
+
+    // поиск бота в потоке окна с квантами планировщика; false - прежний режим: окно ждёт конца расчёта,
+    // задержка хода бота идёт отдельным потоком
+    bool single_thread() const
+    {
+        return config.value("Bot", json::object()).value("SingleThread", true);
+    }
+
+    // уровень (глубина поиска) бота стороны color
+    int bot_level(const bool color) const
+    {
+        return config["Bot"][string(color ? "Black" : "White") + "BotLevel"];
+    }
+
   private:
     json config;
 };
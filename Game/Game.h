@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include <chrono>
 #include <thread>
 
@@ -6,15 +7,25 @@
 #include "Board.h"
 #include "Config.h"
 #include "Hand.h"
-#include "Logic.h"
+#include "Scheduler.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Pdn.h"
+#include "../Engine/Snapshot.h"
 
-class Game
+// партия в вариант шашек G (Engine/Geometry.h), вариант выбирается в main по настройке Game.BoardSize
+template <class G> class Game
 {
   public:
-    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board), logic(&board, &config)
+    Game()
+        : board(config("WindowSize", "Width"), config("WindowSize", "Hight"), G::N),
+          scheduler(&board, config.frame_ms()), hand(&board, &scheduler),
+          logics{Logic<G>(config.bot_settings(false)), Logic<G>(config.bot_settings(true))}
     {
-        ofstream fout(project_path + "log.txt", ios_base::trunc);
-        fout.close();
+        // лог пишется фоновым потоком, ходы и отрисовка не ждут файлового ввода-вывода
+        logger().open(project_path + "log.txt", config("Log", "Trace") ? project_path + "trace.json" : "",
+                      config.log_level());
+        set_levels();
+        load_tables();
     }
 
     // to start checkers
@@ -23,39 +34,65 @@ class Game
 {
     // засекаем время начала игры.
     auto start = chrono::steady_clock::now();
+    int first_turn = 0; // номер первого хода: не 0, если партия продолжается из снимка
 
     if (is_replay)
     {
         // если включён режим повтора, перезагружаем логику и настройки и обновляем доску  
-        logic = Logic(&board, &config);
         config.reload();
+        save_tables();
+        logics[0] = Logic<G>(config.bot_settings(false));
+        logics[1] = Logic<G>(config.bot_settings(true));
+        set_levels();
+        load_tables();
         board.redraw();
     }
     else
     {
         // если это новый запуск, рисуем начальное состояние доски
         board.start_draw();
+        // незаконченная партия прошлого запуска продолжается с того же хода
+        game_snapshot snap;
+        if (config("Snapshot", "Resume") && load_snapshot(snapshot_path, snap) && snap.board_size == G::N)
+        {
+            board.restore(snap.history, snap.beat_series);
+            first_turn = snap.turn_num;
+            logger().info("snapshot", "restored", {{"turn", snap.turn_num}, {"positions", snap.history.size()}});
+        }
     }
 
     // сбрасываем флаг повтора игры
     is_replay = false;
 
-    int turn_num = -1;  // текущий номер хода
+    int turn_num = first_turn - 1;  // текущий номер хода
     bool is_quit = false;  // флаг выхода из игры
+    bool is_draw = false;  // ничья по правилу ходов дамками без взятий
     const int Max_turns = config("Game", "MaxNumTurns");  // максимальное количество ходов
+    const int No_progress_limit = config("Game", "NoProgressLimit");
 
     while (++turn_num < Max_turns) // цикл обработки ходов
     {  
         beat_series = 0; // сбрасываем счётчик серии ходов
+        board.flush(); // показываем позицию перед ходом, в том числе перед долгим расчётом бота
+        // снимок перед каждым ходом: после падения или перезапуска партия продолжится отсюда
+        if (config("Snapshot", "Resume"))
+            save_snapshot(snapshot_path, {G::N, turn_num, board.history_mtx, board.get_beat_series()});
         
+        // движок стороны на ходу: у каждой стороны свои настройки и таблицы
+        Logic<G> &logic = logics[turn_num % 2];
         // поиск доступных ходов для текущего игрока (0 — белый, 1 — чёрный)
-        logic.find_turns(turn_num % 2);
+        logic.find_turns(turn_num % 2, board.get_board());
         if (logic.turns.empty())
             break; // если ходов нет, выходим из цикла
 
-        // устанавливаем максимальную глубину анализа для бота
-        logic.Max_depth = config("Bot", string((turn_num % 2) ? "Black" : "White") + string("BotLevel"));
-        
+        // история обратимых ходов нужна поиску для распознавания повторений
+        logic.set_history(board.history_mtx, turn_num % 2);
+        if (No_progress_limit && logic.history_quiet_plies() >= No_progress_limit)
+        {
+            is_draw = true;
+            break;
+        }
+
         // проверяем, является ли текущий игрок ботом
         if (!config("Bot", string("Is") + string((turn_num % 2) ? "Black" : "White") + string("Bot")))
         {
@@ -91,7 +128,11 @@ class Game
         else
         {
             // ход бота
-            bot_turn(turn_num % 2);
+            if (bot_turn(turn_num % 2) == Response::QUIT)
+            {
+                is_quit = true;
+                break;
+            }
         }
     }
 
@@ -99,28 +140,33 @@ class Game
     auto end = chrono::steady_clock::now();
 
     // записываем время игры в лог
-    ofstream fout(project_path + "log.txt", ios_base::app);
-    fout << "Game time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
-    fout.close();
+    logger().info("game", "", {{"ms", (int)chrono::duration<double, milli>(end - start).count()},
+                               {"turns", turn_num}});
 
     if (is_replay)
         return play(); // повтор игры, если установлен соответствующий флаг
     
     if (is_quit)
+    {
+        save_tables();
         return 0; // завершение игры
+    }
 
     int res = 2; // результат игры (по умолчанию ничья)
-    if (turn_num == Max_turns)
+    if (turn_num == Max_turns || is_draw)
     {
-        res = 0; // ничья из-за достижения максимального числа ходов
+        res = 0; // ничья из-за достижения максимального числа ходов или ходов дамками без взятий
     }
     else if (turn_num % 2)
     {
         res = 1; // победа чёрного игрока
     }
 
-    // отображение итогового результата игры
+    save_pdn(res);
+
+    // отображение итогового результата игры; законченную партию продолжать не нужно
     board.show_final(res);
+    remove(snapshot_path.c_str());
 
     // ожидание ответа от игрока после завершения игры (например, перезапуск игры)
     auto resp = hand.wait();
@@ -130,41 +176,123 @@ class Game
         return play();
     }
 
+    save_tables();
     return res; // возвращаем результат игры
 }
 
 
   private:
-    void bot_turn(const bool color) {
+    // глубина поиска каждой стороны; температура выбора хода приходит в движок с настройками стороны.
+    // В режиме SingleThread поиск каждые YieldNodes узлов отдаёт квант планировщику
+    void set_levels()
+    {
+        for (const bool color : {false, true})
+        {
+            logics[color].Max_depth = config.bot_level(color);
+            if (config.single_thread())
+                logics[color].set_yield_hook([this]() { return scheduler.slice(); }, config.yield_nodes());
+            else
+                logics[color].set_yield_hook(nullptr, 0);
+        }
+    }
 
-    auto start = chrono::steady_clock::now(); // начало отсчета времени выполнения хода бота
-    auto delay_ms = config("Bot", "BotDelayMS");  // получение настройки задержки для хода бота в миллисекундах
-    
-    thread th(SDL_Delay, delay_ms); // создание нового потока для обеспечения равномерной задержки перед ходом
+    // таблицы движка переживают перезапуск, если включено в разделе "Snapshot"; у каждой стороны свой файл
+    void save_tables()
+    {
+        if (!config("Snapshot", "Tables"))
+            return;
+        for (const bool color : {false, true})
+            logics[color].save_tables(tables_path(color));
+    }
 
-    auto turns = logic.find_best_turns(color);  // определение лучших ходов для бота на основе указанного цвета
+    void load_tables()
+    {
+        if (!config("Snapshot", "Tables"))
+            return;
+        for (const bool color : {false, true})
+            logics[color].load_tables(tables_path(color));
+    }
 
-    th.join(); // ожидание завершения потока задержки
+    string tables_path(const bool color) const
+    {
+        return project_path + (color ? "solver_table_black.bin" : "solver_table_white.bin");
+    }
+
+    // законченная партия дописывается в архив PDN из настройки Game.PDNFile (пустая строка - не писать).
+    // res - как в show_final: 1 - выиграли белые, 2 - чёрные, 0 - ничья
+    void save_pdn(const int res)
+    {
+        const string file = config("Game", "PDNFile");
+        if (file.empty())
+            return;
+        auto player = [this](const bool color) {
+            const string side = color ? "Black" : "White";
+            if (!config("Bot", "Is" + side + "Bot"))
+                return string("Player");
+            const int level = config("Bot", side + "BotLevel");
+            return "Bot level " + to_string(level);
+        };
+        pdn_game game;
+        game.board_size = G::N;
+        game.tags = {{"Event", "Checkers"}, {"Date", pdn_date()}, {"White", player(false)}, {"Black", player(true)}};
+        game.moves = moves_from_history(logics[0], board.history_mtx);
+        game.result = pdn_result(G::N, res == 1 ? 1 : (res == 2 ? -1 : 0));
+        if (!append_pdn(project_path + file, game))
+            logger().warning("pdn", "cannot write " + file);
+    }
+
+    // ход бота; QUIT - окно закрыли во время расчёта или показа хода
+    Response bot_turn(const bool color) {
+
+    auto start = chrono::steady_clock::now(); // начало отсчета времени выполнения хода бота
+    trace_span span("bot_turn");
+    Logic<G> &logic = logics[color];
+    const int delay_ms = config("Bot", "BotDelayMS");  // получение настройки задержки для хода бота в миллисекундах
+    const bool single_thread = config.single_thread();
+
+    thread th; // прежний режим: поток для обеспечения равномерной задержки перед ходом
+    if (!single_thread)
+        th = thread(SDL_Delay, delay_ms);
+
+    // лучший полный ход бота: вся серия взятий сразу. В режиме SingleThread окно обновляется из кванта
+    // планировщика, иначе ждёт конца расчёта
+    auto best = logic.find_best_turns(color, board.get_board());
+
+    // равномерная задержка перед ходом досыпается с выводом кадров, без отдельного потока
+    if (single_thread)
+        scheduler.wait_until(start + chrono::milliseconds(delay_ms));
+    else
+        th.join(); // ожидание завершения потока задержки
+    if (scheduler.take_quit())
+        return Response::QUIT; // окно закрыли во время расчёта: ход брошенного поиска не играется
     bool is_first = true; // флаг для проверки, является ли это первый ход в последовательности
 
-    for (auto turn : turns){ // выполнение каждого хода из найденной последовательности лучших ходов
+    for (size_t k = 0; k < best.steps.size(); ++k){ // выполнение по шагам, чтобы серия взятий была видна и откатывалась как раньше
+        const auto &turn = best.steps[k];
     
         if (!is_first) // если это не первый ход, добавляется задержка перед его выполнением
         {
-            SDL_Delay(delay_ms);
+            if (single_thread)
+                scheduler.wait_for(delay_ms);
+            else
+                SDL_Delay(delay_ms);
         }
         is_first = false;
         beat_series += (turn.xb != -1);    // обновление счетчика серии ударов, если захвачена фигура
 
-        board.move_piece(turn, beat_series);  // выполнение хода на игровом поле
+        // выполнение хода на игровом поле; без превращения во время взятия дамкой становятся на последнем шаге
+        board.move_piece(turn, beat_series, G::Promote_during_capture || k + 1 == best.steps.size());
+        logger().instant("move", {{"x", turn.x}, {"y", turn.y}, {"x2", turn.x2}, {"y2", turn.y2}});
+        board.flush(); // каждый шаг серии виден отдельно
     }
 
     auto end = chrono::steady_clock::now();   // завершение отсчета времени и расчет времени выполнения хода
 
     // запись времени выполнения хода бота в файл лога
-    ofstream fout(project_path + "log.txt", ios_base::app);
-    fout << "Bot turn time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
-    fout.close();
+    logger().info("bot_turn", "", {{"ms", (int)chrono::duration<double, milli>(end - start).count()},
+                                   {"color", color ? "black" : "white"}, {"depth", logic.Max_depth},
+                                   {"nodes", logic.nodes}});
+    return scheduler.take_quit() ? Response::QUIT : Response::OK;
 }
 
 
@@ -174,9 +302,24 @@ Response player_turn(const bool color)
     // параметр "color" определяет текущий цвет игрока (true — чёрный, false — белый)
     // возвращает "Response", который сигнализирует о статусе хода
 
+    // все полные ходы игрока без склейки разных порядков взятий: серия вводится по шагам,
+    // допустимый шаг - продолжение хотя бы одной серии (так соблюдается и правило большинства)
+    const auto series = logics[color].find_series(color, board.get_board(), false);
+    vector<move_pos> done; // сделанные шаги серии
+    auto next_steps = [&series, &done]() {
+        vector<move_pos> res;
+        for (const auto &s : series)
+        {
+            if (s.steps.size() > done.size() && equal(done.begin(), done.end(), s.steps.begin()))
+                res.push_back(s.steps[done.size()]);
+        }
+        return res;
+    };
+    const auto first_steps = next_steps();
+
     vector<pair<POS_T, POS_T>> cells;
     // собираем список возможных ходов для текущего игрока
-    for (auto turn : logic.turns)
+    for (auto turn : first_steps)
     {
         cells.emplace_back(turn.x, turn.y); // добавляем стартовые координаты хода
     }
@@ -199,7 +342,7 @@ Response player_turn(const bool color)
         bool is_correct = false; // флаг корректности выбранного хода
 
         // проверяем, соответствует ли выбор игрока возможному ходу
-        for (auto turn : logic.turns)
+        for (auto turn : first_steps)
         {
             if (turn.x == cell.first && turn.y == cell.second)
             {
@@ -238,7 +381,7 @@ Response player_turn(const bool color)
         board.set_active(x, y);
 
         vector<pair<POS_T, POS_T>> cells2;
-        for (auto turn : logic.turns)
+        for (auto turn : first_steps)
         {
             if (turn.x == x && turn.y == y)
             {
@@ -253,7 +396,9 @@ Response player_turn(const bool color)
     board.clear_active();
 
     // выполняем ход и проверяем, есть ли возможность продолжения битья
-    board.move_piece(pos, pos.xb != -1);
+    done.push_back(pos);
+    board.move_piece(pos, pos.xb != -1, G::Promote_during_capture || next_steps().empty());
+    logger().instant("move", {{"x", pos.x}, {"y", pos.y}, {"x2", pos.x2}, {"y2", pos.y2}});
     if (pos.xb == -1)
         return Response::OK; // если битье не продолжается, возвращаем успешный статус
 
@@ -262,12 +407,12 @@ Response player_turn(const bool color)
     while (true)
     {
         // находим доступные ходы для продолжения битья
-        logic.find_turns(pos.x2, pos.y2);
-        if (!logic.have_beats)
+        const auto turns = next_steps();
+        if (turns.empty())
             break; // если битья больше нет, выходим из цикла
 
         vector<pair<POS_T, POS_T>> cells;
-        for (auto turn : logic.turns)
+        for (auto turn : turns)
         {
             cells.emplace_back(turn.x2, turn.y2); // добавляем клетки для продолжения
         }
@@ -286,7 +431,7 @@ Response player_turn(const bool color)
             pair<POS_T, POS_T> cell{get<1>(resp), get<2>(resp)};
 
             bool is_correct = false; // флаг корректности выбранного хода
-            for (auto turn : logic.turns)
+            for (auto turn : turns)
             {
                 if (turn.x2 == cell.first && turn.y2 == cell.second)
                 {
@@ -302,7 +447,9 @@ Response player_turn(const bool color)
             board.clear_highlight();
             board.clear_active();
             beat_series += 1; // увеличиваем счётчик серии
-            board.move_piece(pos, beat_series);
+            done.push_back(pos);
+            board.move_piece(pos, beat_series, G::Promote_during_capture || next_steps().empty());
+            logger().instant("move", {{"x", pos.x}, {"y", pos.y}, {"x2", pos.x2}, {"y2", pos.y2}});
             break;
         }
     }
@@ -314,8 +461,10 @@ Response player_turn(const bool color)
   private:
     Config config;
     Board board;
+    Scheduler scheduler; // поиск, события окна и кадры в одном потоке
     Hand hand;
-    Logic logic;
+    Logic<G> logics[2]; // движки белых и чёрных
     int beat_series;
     bool is_replay = false;
+    const string snapshot_path = project_path + "snapshot.bin";
 };
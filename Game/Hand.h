@@ -4,13 +4,14 @@
 #include "../Models/Move.h"
 #include "../Models/Response.h"
 #include "Board.h"
+#include "Scheduler.h"
 
 // класс Hand: отвечает за обработку пользовательского ввода 
 class Hand
 {
   public:
-    // конструктор: инициализирует объект Hand и связывает его с игровой доской 
-    Hand(Board *board) : board(board)
+    // конструктор: инициализирует объект Hand и связывает его с игровой доской и планировщиком кадров
+    Hand(Board *board, Scheduler *scheduler) : board(board), scheduler(scheduler)
     {
     }
 
@@ -21,11 +22,14 @@ class Hand
         Response resp = Response::OK; // изначальный статус ответа
         int x = -1, y = -1;           // координаты клика мыши 
         int xc = -1, yc = -1;         // координаты клетки на доске
+        trace_span span("input_wait");
 
         // основной цикл обработки событий
         while (true)
         {
-            if (SDL_PollEvent(&windowEvent))
+            // не больше одного вывода кадра за итерацию, даже если доска менялась несколько раз;
+            // без событий поток спит, а не опрашивает очередь
+            if (scheduler->next_event(windowEvent))
             {
                 switch (windowEvent.type)
                 {
@@ -38,19 +42,19 @@ class Hand
                     // обработка клика мыши: определяем, какая клетка выбрана
                     x = windowEvent.motion.x; // координата X клика 
                     y = windowEvent.motion.y; // координата Y клика
-                    xc = int(y / (board->H / 10) - 1); // координата строки на доске
-                    yc = int(x / (board->W / 10) - 1); // координата столбца на доске
+                    xc = int(y / (board->H / (board->N + 2)) - 1); // координата строки на доске
+                    yc = int(x / (board->W / (board->N + 2)) - 1); // координата столбца на доске
 
                     // определяем тип действия на основе координат клетки
                     if (xc == -1 && yc == -1 && board->history_mtx.size() > 1)
                     {
                         resp = Response::BACK; // игрок выбрал действие "откатить ход"
                     }
-                    else if (xc == -1 && yc == 8)
+                    else if (xc == -1 && yc == board->N)
                     {
                         resp = Response::REPLAY; // игрок выбрал "начать заново"
                     }
-                    else if (xc >= 0 && xc < 8 && yc >= 0 && yc < 8)
+                    else if (xc >= 0 && xc < board->N && yc >= 0 && yc < board->N)
                     {
                         resp = Response::CELL; // выбрана игровая клетка
                     }
@@ -61,14 +65,6 @@ class Hand
                         yc = -1;
                     }
                     break;
-
-                case SDL_WINDOWEVENT:
-                    // обработка изменения размера окна
-                    if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
-                    {
-                        board->reset_window_size(); // пересчитываем размеры доски
-                        break;
-                    }
                 }
 
                 // если событие не является "OK", выходим из цикла обработки
@@ -86,11 +82,12 @@ class Hand
     {
         SDL_Event windowEvent; // событие SDL
         Response resp = Response::OK; // изначальный статус ответа
+        trace_span span("input_wait");
 
         // основной цикл ожидания события
         while (true)
         {
-            if (SDL_PollEvent(&windowEvent))
+            if (scheduler->next_event(windowEvent))
             {
                 switch (windowEvent.type)
                 {
@@ -98,17 +95,13 @@ class Hand
                     resp = Response::QUIT; // пользователь закрыл окно
                     break;
 
-                case SDL_WINDOWEVENT_SIZE_CHANGED:
-                    board->reset_window_size(); // пересчитываем размеры доски
-                    break;
-
                 case SDL_MOUSEBUTTONDOWN: {
                     // обработка клика мыши: проверяем, выбрал ли игрок "начать заново"
                     int x = windowEvent.motion.x;
                     int y = windowEvent.motion.y;
-                    int xc = int(y / (board->H / 10) - 1);
-                    int yc = int(x / (board->W / 10) - 1);
-                    if (xc == -1 && yc == 8)
+                    int xc = int(y / (board->H / (board->N + 2)) - 1);
+                    int yc = int(x / (board->W / (board->N + 2)) - 1);
+                    if (xc == -1 && yc == board->N)
                         resp = Response::REPLAY; // игрок выбрал "начать заново"
                 }
                 break;
@@ -126,4 +119,5 @@ class Hand
 
   private:
     Board *board; // указатель на объект доски, для взаимодействия с её состоянием
+    Scheduler *scheduler; // вывод кадров и события окна во время ожидания ввода
 };
@@ -0,0 +1,108 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+
+#include "Board.h"
+
+// Кооперативный планировщик: поиск бота, события окна и вывод кадров идут в одном потоке, без потоков
+// на ход. Поиск каждые Bot.YieldNodes узлов вызывает slice(): если подошло время кадра, планировщик
+// разбирает события окна и выводит кадр, иначе сразу возвращает управление поиску. Остальное время кадра
+// достаётся поиску. Ожидания (задержка хода бота, ввод игрока) спят до события или следующего кадра
+class Scheduler
+{
+  public:
+    Scheduler(Board *board, const int frame_ms) : board(board), frame_ms(max(frame_ms, 1))
+    {
+    }
+
+    // квант поиска: false - окно закрыли, поиск можно бросить
+    bool slice()
+    {
+        const auto now = chrono::steady_clock::now();
+        if (now < next_frame)
+            return !quit;
+        next_frame = now + chrono::milliseconds(frame_ms);
+        pump();
+        board->flush();
+        return !quit;
+    }
+
+    // ожидание до момента deadline с выводом кадров; сон кадрами, а не отдельный поток задержки
+    void wait_until(const chrono::steady_clock::time_point deadline)
+    {
+        while (!quit)
+        {
+            pump();
+            board->flush();
+            const auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+            if (left.count() <= 0)
+                break;
+            SDL_Delay(Uint32(min<long long>(left.count(), frame_ms)));
+        }
+    }
+
+    void wait_for(const int ms)
+    {
+        wait_until(chrono::steady_clock::now() + chrono::milliseconds(ms));
+    }
+
+    // следующее событие ввода игрока: перед ожиданием выводится кадр, события окна разбираются здесь же.
+    // false - за кадр событий для ввода не пришло
+    bool next_event(SDL_Event &event)
+    {
+        board->flush();
+        if (!SDL_WaitEventTimeout(&event, frame_ms))
+            return false;
+        return !handle_window(event);
+    }
+
+    // окно закрыли, пока шёл поиск или ожидание; флаг снимается чтением
+    bool take_quit()
+    {
+        const bool res = quit;
+        quit = false;
+        return res;
+    }
+
+  private:
+    // из очереди забираются только закрытие окна, события окна и потеря слоёв - каждый тип отдельно: диапазон
+    // SDL_QUIT..SDL_WINDOWEVENT задел бы события жизни приложения и дисплея. Щелчки остаются для ввода игрока
+    void pump()
+    {
+        SDL_PumpEvents();
+        SDL_Event event;
+        for (const Uint32 type : {Uint32(SDL_QUIT), Uint32(SDL_WINDOWEVENT), Uint32(SDL_RENDER_TARGETS_RESET)})
+            while (SDL_PeepEvents(&event, 1, SDL_GETEVENT, type, type) > 0)
+            {
+                if (event.type == SDL_QUIT)
+                    quit = true;
+                else
+                    handle_window(event);
+            }
+    }
+
+    // изменение размера, перекрытие окна и потеря слоёв драйвером; true - событие разобрано
+    bool handle_window(const SDL_Event &event)
+    {
+        switch (event.type)
+        {
+        case SDL_WINDOWEVENT:
+            if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+                board->reset_window_size(); // пересчитываем размеры доски
+            else if (event.window.event == SDL_WINDOWEVENT_EXPOSED)
+                board->repaint(); // окно было перекрыто, выводим кадр заново
+            return true;
+
+        case SDL_RENDER_TARGETS_RESET:
+            // драйвер потерял содержимое кэшированных слоёв
+            board->reset_layers();
+            return true;
+        }
+        return false;
+    }
+
+    Board *board;
+    const int frame_ms; // бюджет кадра: интерфейс обновляется не реже раза за frame_ms
+    chrono::steady_clock::time_point next_frame;
+    bool quit = false;
+};
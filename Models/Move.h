@@ -1,5 +1,7 @@
 #pragma once
+#include <stdint.h>
 #include <stdlib.h>
+#include <vector>
 
 typedef int8_t POS_T; // тип данных для хранения координат 
 
@@ -33,3 +35,11 @@ struct move_pos
         return !(*this == other); // инвертируем результат оператора равенства
     }
 };
+
+// структура move_series - полный ход: вся серия взятий одной фигурой или один тихий ход
+struct move_series
+{
+    std::vector<move_pos> steps;              // шаги серии по порядку
+    uint64_t captured = 0;                    // маска побитых фигур, бит (x * N + y) / 2 - номер тёмной клетки
+    std::vector<std::vector<POS_T>> position; // позиция после хода
+};
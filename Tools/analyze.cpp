@@ -0,0 +1,291 @@
+// Пакетный анализ позиций: оценка, лучший ход, главный вариант, узлы и время для каждой позиции файла.
+// Позиции - по одной на строку в записи position_line (Engine/Position.h), пустые строки и строки с '#'
+// пропускаются. Файл читается потоково, позиции разбирают потоки пула, результат - JSON-массив
+// в порядке входа (по объекту на строку). При --time-ms глубина растёт, пока следующая итерация
+// по прогнозу укладывается во время позиции, до MaxAnalysisDepth или до --depth, если она задана.
+// Без --time-ms глубина - --depth (5 по умолчанию).
+//   analyze [--depth D] [--time-ms MS] [--threads T] [--optimization O0|O1|O2] [--scoring TYPE]
+//           [--no-progress-limit K] [--out FILE] [FILE]
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Engine/Logic.h"
+
+using namespace std;
+
+// позиций между чтением и записью на один поток: дальше чтение ждёт, память не растёт с размером файла
+const size_t InFlightPerThread = 64;
+// предел глубины итеративного углубления по времени
+const int MaxAnalysisDepth = 30;
+// глубина анализа без --depth и --time-ms
+const int DefaultAnalysisDepth = 5;
+
+struct analysis_task
+{
+    size_t index = 0; // номер позиции во входе
+    size_t line = 0;  // номер строки файла
+    string text;
+};
+
+struct analysis_options
+{
+    int depth = -1; // -1 - не задана: DefaultAnalysisDepth, а по времени - без предела
+    int time_ms = 0;
+};
+
+// главный вариант после лучшего хода: лучший ответ ищется в каждой следующей позиции на глубину
+// на полуход меньше, как в поддереве исходного поиска
+template <class G>
+vector<string> principal_variation(Logic<G> &logic, const move_series &best, bool color, const int depth,
+                                   size_t &nodes)
+{
+    vector<string> pv = {series_text(best)};
+    auto mtx = best.position;
+    for (int d = depth - 1; d >= 0; --d)
+    {
+        color = !color;
+        logic.Max_depth = d;
+        auto lines = logic.find_top_turns(color, mtx, 1);
+        nodes += logic.nodes;
+        if (lines.empty())
+            break;
+        pv.push_back(series_text(lines[0].series));
+        mtx = move(lines[0].series.position);
+    }
+    return pv;
+}
+
+// анализ одной позиции, результат - объект JSON
+template <class G>
+string analyze_position(Logic<G> &logic, const analysis_task &task, const vector<vector<POS_T>> &mtx,
+                        const bool color, const analysis_options &options)
+{
+    auto start = chrono::steady_clock::now();
+    auto elapsed_ms = [&start]() {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    };
+    // равные ходы перемешиваются с одним зерном: результат не зависит от того, какой поток взял позицию
+    logic.seed(0);
+    size_t nodes = 0;
+    vector<root_line> lines;
+    int depth = options.time_ms ? 0 : (options.depth >= 0 ? options.depth : DefaultAnalysisDepth);
+    if (!options.time_ms)
+    {
+        logic.Max_depth = depth;
+        lines = logic.find_top_turns(color, mtx, 1);
+        nodes = logic.nodes;
+    }
+    else
+    {
+        // итеративное углубление: итерация не прерывается, поэтому следующая начинается, только если
+        // по отношению времени двух последних итераций она закончится до срока
+        const int max_depth = options.depth >= 0 ? min(options.depth, MaxAnalysisDepth) : MaxAnalysisDepth;
+        double last_ms = 0, growth = 4;
+        for (int d = 0; d <= max_depth; ++d)
+        {
+            const double iteration_start = elapsed_ms();
+            if (d && iteration_start + last_ms * growth > options.time_ms)
+                break;
+            logic.Max_depth = d;
+            lines = logic.find_top_turns(color, mtx, 1);
+            nodes += logic.nodes;
+            depth = d;
+            const double iteration_ms = elapsed_ms() - iteration_start;
+            if (last_ms > 0.01)
+                growth = max(1.0, iteration_ms / last_ms);
+            last_ms = iteration_ms;
+            if (lines.empty() || lines[0].score >= INF || lines[0].score <= 0)
+                break; // исход уже известен
+        }
+    }
+
+    ostringstream out;
+    out << "{\"line\": " << task.line << ", \"position\": \"" << position_line(mtx, color) << "\"";
+    if (lines.empty())
+    {
+        // ходить нечем - сторона на ходу проиграла
+        out << ", \"score\": 0, \"depth\": 0, \"best\": null, \"pv\": []";
+    }
+    else
+    {
+        const auto pv = principal_variation(logic, lines[0].series, color, depth, nodes);
+        out << ", \"score\": " << lines[0].score << ", \"depth\": " << depth << ", \"best\": \"" << pv[0]
+            << "\", \"pv\": [";
+        for (size_t k = 0; k < pv.size(); ++k)
+            out << (k ? ", \"" : "\"") << pv[k] << "\"";
+        out << "]";
+    }
+    out << ", \"nodes\": " << nodes << ", \"ms\": " << elapsed_ms() << "}";
+    return out.str();
+}
+
+// Очередь позиций и упорядоченный вывод. Потоки пула берут позиции по одной, готовые результаты
+// пишутся, как только готовы все предыдущие позиции
+class batch_analyzer
+{
+  public:
+    batch_analyzer(const engine_settings &settings, const analysis_options &options, const int threads, ostream &out)
+        : settings(settings), options(options), limit(InFlightPerThread * size_t(threads)), out(out)
+    {
+        for (int t = 0; t < threads; ++t)
+            pool.emplace_back(&batch_analyzer::worker, this);
+    }
+
+    // добавляет позицию; ждёт, если слишком много позиций ещё не записано
+    void push(analysis_task task)
+    {
+        unique_lock<mutex> lock(mtx);
+        space.wait(lock, [this]() { return next_index - written < limit; });
+        task.index = next_index++;
+        tasks.push_back(move(task));
+        ready.notify_one();
+    }
+
+    // дожидается анализа всех позиций
+    void finish()
+    {
+        {
+            lock_guard<mutex> lock(mtx);
+            closed = true;
+        }
+        ready.notify_all();
+        for (auto &th : pool)
+            th.join();
+    }
+
+    size_t count() const
+    {
+        return written;
+    }
+
+  private:
+    void worker()
+    {
+        // у каждого потока свои движки: Logic не потокобезопасен
+        Logic<geometry<8>> logic8(settings);
+        Logic<geometry<10>> logic10(settings);
+        while (true)
+        {
+            analysis_task task;
+            {
+                unique_lock<mutex> lock(mtx);
+                ready.wait(lock, [this]() { return !tasks.empty() || closed; });
+                if (tasks.empty())
+                    return;
+                task = move(tasks.front());
+                tasks.pop_front();
+            }
+            vector<vector<POS_T>> position;
+            bool color = false;
+            string json;
+            if (!parse_position_line(task.text, position, color))
+                json = "{\"line\": " + to_string(task.line) + ", \"error\": \"bad position\"}";
+            else if (position.size() == 10)
+                json = analyze_position(logic10, task, position, color, options);
+            else
+                json = analyze_position(logic8, task, position, color, options);
+            write(task.index, move(json));
+        }
+    }
+
+    void write(const size_t index, string json)
+    {
+        lock_guard<mutex> lock(mtx);
+        done.emplace(index, move(json));
+        while (!done.empty() && done.begin()->first == written)
+        {
+            out << (written ? ",\n" : "[\n") << done.begin()->second;
+            done.erase(done.begin());
+            ++written;
+        }
+        space.notify_one();
+    }
+
+    const engine_settings settings;
+    const analysis_options options;
+    const size_t limit;
+    ostream &out;
+    vector<thread> pool;
+    mutex mtx;
+    condition_variable ready; // появилась позиция или вход закончился
+    condition_variable space; // записаны результаты, можно читать дальше
+    deque<analysis_task> tasks;
+    map<size_t, string> done; // готовые результаты, ждущие записи предыдущих
+    size_t next_index = 0;
+    size_t written = 0;
+    bool closed = false;
+};
+
+int main(int argc, char *argv[])
+{
+    engine_settings settings;
+    settings.no_random = true;
+    analysis_options options;
+    int threads = max(1, int(thread::hardware_concurrency()));
+    string path, out_path;
+    for (int k = 1; k < argc; ++k)
+    {
+        const string arg = argv[k];
+        if (arg == "--depth" && k + 1 < argc)
+            options.depth = atoi(argv[++k]);
+        else if (arg == "--time-ms" && k + 1 < argc)
+            options.time_ms = atoi(argv[++k]);
+        else if (arg == "--threads" && k + 1 < argc)
+            threads = max(1, atoi(argv[++k]));
+        else if (arg == "--optimization" && k + 1 < argc)
+            settings.optimization = argv[++k];
+        else if (arg == "--scoring" && k + 1 < argc)
+            settings.scoring_mode = argv[++k];
+        else if (arg == "--no-progress-limit" && k + 1 < argc)
+            settings.no_progress_limit = atoi(argv[++k]);
+        else if (arg == "--out" && k + 1 < argc)
+            out_path = argv[++k];
+        else
+            path = arg;
+    }
+
+    ifstream fin;
+    if (!path.empty())
+    {
+        fin.open(path);
+        if (!fin)
+        {
+            cerr << "cannot open " << path << endl;
+            return 1;
+        }
+    }
+    istream &in = path.empty() ? cin : fin;
+    ofstream fout;
+    if (!out_path.empty())
+        fout.open(out_path);
+    ostream &out = out_path.empty() ? cout : fout;
+
+    auto start = chrono::steady_clock::now();
+    batch_analyzer analyzer(settings, options, threads, out);
+    string line;
+    size_t line_num = 0;
+    while (getline(in, line))
+    {
+        ++line_num;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line[0] == '#')
+            continue;
+        analyzer.push({0, line_num, line});
+    }
+    analyzer.finish();
+    out << (analyzer.count() ? "\n]\n" : "[]\n");
+    cerr << "positions: " << analyzer.count() << ", threads: " << threads << ", time: "
+         << (int)chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " millisec" << endl;
+    return 0;
+}
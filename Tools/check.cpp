@@ -0,0 +1,109 @@
+// Проверки правил и решателя на позициях с известным ответом. Печатает результат каждой проверки,
+// код выхода 1, если хоть одна не прошла:
+//   check
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../Engine/Logic.h"
+#include "../Engine/Pdn.h"
+
+using namespace std;
+
+static int failed = 0;
+
+static void expect(const bool ok, const string &name)
+{
+    cout << (ok ? "ok   " : "FAIL ") << name << "\n";
+    failed += !ok;
+}
+
+// ходы позиции в записи series_text, в порядке find_series
+template <class G> vector<string> moves_text(const vector<string> &rows, const bool color)
+{
+    engine_settings settings;
+    settings.no_random = true;
+    Logic<G> logic(settings);
+    vector<string> res;
+    for (const auto &series : logic.find_series(color, parse_position(rows), false))
+        res.push_back(series_text(series));
+    return res;
+}
+
+// турецкий удар (10x10): дамка бьёт шашку 2,1 и не может вернуться через её клетку к шашке 8,7.
+// Со снятием фигур посреди серии взятие двух было бы единственным ходом по правилу большинства
+static void check_turkish_strike()
+{
+    const vector<string> rows = {"..........", "..........", ".b........", "..........", "...W......",
+                                 "..........", "..........", "..........", ".......b..", ".........."};
+    const auto moves = moves_text<geometry<10>>(rows, false);
+    bool single_captures = !moves.empty();
+    for (const auto &text : moves)
+        single_captures = single_captures && count(text.begin(), text.end(), '-') == 1;
+    expect(single_captures && moves.size() == 2, "10x10: captured piece stays on the board until the move ends");
+}
+
+// выигрыш дамкой против дамки, который успевает только при свежей серии ходов дамками: при пределе
+// NoProgressLimit 6 и четырёх ходах дамками перед позицией это ничья. Решатель с той же таблицей
+// не должен брать доказательство, найденное при серии 0
+static void check_solver_quiet()
+{
+    engine_settings settings;
+    settings.no_random = true;
+    settings.no_progress_limit = 6;
+    settings.solver_memory_mb = 4;
+    PnSolver<geometry<8>> solver(settings);
+    const auto mtx = parse_position({".......B", "........", "........", "....W...", "........", "........",
+                                     "........", "........"});
+    const bool fresh_win = solver.solve(false, mtx, 0, false).result == 1;
+    const bool late_win = solver.solve(false, mtx, 4, false).result == 1;
+    expect(fresh_win && !late_win, "solver: proof with a fresh king-move count is not reused after king moves");
+}
+
+// пакетная оценка AVX2 (если процессор умеет) совпадает с оценкой по одной позиции, в обоих режимах
+// оценки и для обеих сторон
+static void check_score_batch()
+{
+    engine_settings settings;
+    settings.no_random = true;
+    Logic<geometry<8>> logic(settings);
+    const auto mtx = parse_position({".b.b.b.b", "b.b.b.b.", ".......b", "..b.....", ".W...W..", "W...W.W.",
+                                     ".W.W.W.W", "W.B.W.W."});
+    leaf_batch batch;
+    const auto parent = position_masks<geometry<8>>(mtx);
+    for (const bool color : {false, true})
+        for (const auto &series : logic.find_series(color, mtx))
+            batch.push(child_masks<geometry<8>>(parent, mtx, series));
+    batch.push(piece_masks{});
+    bool same = batch.size() >= 8;
+    for (const bool potential : {false, true})
+        for (const bool first_bot_color : {false, true})
+        {
+            vector<double> scalar(batch.size()), fast(batch.size());
+            score_batch_scalar<geometry<8>>(batch, potential, first_bot_color, INF, scalar.data());
+            score_batch<geometry<8>>(batch, potential, first_bot_color, INF, fast.data());
+            same = same && scalar == fast;
+        }
+    expect(same, string("score_batch (") + (cpu_has_avx2() ? "avx2" : "scalar") + ") matches score_masks");
+}
+
+// границы партий PDN: запись ходов без тегов в начале файла и после результата - отдельные партии
+static void check_pdn_bounds()
+{
+    const string text = "1. c3-d4 h6-g5 *\n1. c3-b4 1-0\n\n[Event \"x\"]\n[Result \"*\"]\n\n1. c3-d4\n2. d4-e5 *\n";
+    const char *begin = text.data(), *end = begin + text.size();
+    int games = 0;
+    for (const char *p = next_pdn_game(begin, begin, end); p < end; p = next_pdn_game(p + 1, begin, end))
+        ++games;
+    expect(games == 3, "pdn: games without tags are split at the result");
+}
+
+int main()
+{
+    check_turkish_strike();
+    check_solver_quiet();
+    check_score_batch();
+    check_pdn_bounds();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,121 @@
+// Матч двух настроек движка без графики: сила (очки) и время поиска на одной глубине.
+// Цвета чередуются, у каждой пары партий одно зерно случайности.
+// Для MCTS время хода задаёт --time-ms, а не глубина: сравнение силы при равном времени на ход.
+// --temperature-a/b задаёт силу выбором среди --multi-pv лучших ходов при той же глубине.
+// --depth-b даёт b другую глубину: сравнение O2 с O1 при равном времени, а не при равной глубине.
+//   match [--games N] [--depth D] [--depth-b D] [--max-turns T] [--a O1] [--b O2] [--scoring-a TYPE] [--scoring-b TYPE]
+//         [--size 8|10] [--engine-a AlphaBeta|MCTS|Distributed] [--engine-b AlphaBeta|MCTS|Distributed]
+//         [--time-ms MS] [--threads T] [--solver-a PIECES] [--solver-b PIECES] [--temperature-a T]
+//         [--temperature-b T] [--multi-pv K] [--workers ADDRESSES] [--worker-timeout-ms MS]
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "../Engine/Selfplay.h"
+
+using namespace std;
+
+// матч на доске варианта G
+template <class G>
+void run_match(const engine_settings settings[2], const int games, const int depth, const int depth_b, const int max_turns)
+{
+    Logic<G> a(settings[0]), b(settings[1]);
+    a.Max_depth = depth;
+    b.Max_depth = depth_b;
+    double points[2] = {0, 0}, ms[2] = {0, 0};
+    size_t nodes[2] = {0, 0};
+    int searches[2] = {0, 0};
+    for (int game = 0; game < games; ++game)
+    {
+        a.seed(game / 2);
+        b.seed(game / 2);
+        // в чётных партиях a играет белыми, в нечётных - чёрными
+        const int a_color = game % 2;
+        Logic<G> *players[2] = {a_color ? &b : &a, a_color ? &a : &b};
+        auto res = play_game(players, max_turns, settings[0].no_progress_limit);
+        for (int side = 0; side < 2; ++side)
+        {
+            const int engine = (side == a_color) ? 0 : 1;
+            ms[engine] += res.ms[side];
+            nodes[engine] += res.nodes[side];
+            searches[engine] += res.searches[side];
+            if (res.winner == side)
+                points[engine] += 1;
+            else if (res.winner == -1)
+                points[engine] += 0.5;
+        }
+    }
+
+    cout << "games: " << games << ", depth: " << depth;
+    if (depth_b != depth)
+        cout << ", depth b: " << depth_b;
+    cout << ", board: " << G::N << "x" << G::N << "\n";
+    for (int engine = 0; engine < 2; ++engine)
+    {
+        cout << (engine ? "b (" : "a (") << settings[engine].engine << ", " << settings[engine].optimization << ", "
+             << settings[engine].scoring_mode << ", t=" << settings[engine].temperature
+             << "): points " << points[engine] << ", avg search "
+             << (searches[engine] ? ms[engine] / searches[engine] : 0) << " millisec, nodes "
+             << nodes[engine] << "\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int games = 20, depth = 5, depth_b = -1, max_turns = 120, size = 8;
+    engine_settings settings[2];
+    settings[0].optimization = "O1";
+    settings[1].optimization = "O2";
+    for (int k = 1; k + 1 < argc; k += 2)
+    {
+        const string arg = argv[k];
+        if (arg == "--games")
+            games = atoi(argv[k + 1]);
+        else if (arg == "--depth")
+            depth = atoi(argv[k + 1]);
+        else if (arg == "--depth-b")
+            depth_b = atoi(argv[k + 1]);
+        else if (arg == "--max-turns")
+            max_turns = atoi(argv[k + 1]);
+        else if (arg == "--a")
+            settings[0].optimization = argv[k + 1];
+        else if (arg == "--b")
+            settings[1].optimization = argv[k + 1];
+        else if (arg == "--scoring-a")
+            settings[0].scoring_mode = argv[k + 1];
+        else if (arg == "--scoring-b")
+            settings[1].scoring_mode = argv[k + 1];
+        else if (arg == "--size")
+            size = atoi(argv[k + 1]);
+        else if (arg == "--engine-a")
+            settings[0].engine = argv[k + 1];
+        else if (arg == "--engine-b")
+            settings[1].engine = argv[k + 1];
+        else if (arg == "--time-ms")
+            settings[0].mcts_time_ms = settings[1].mcts_time_ms = atoi(argv[k + 1]);
+        else if (arg == "--threads")
+            settings[0].threads = settings[1].threads = atoi(argv[k + 1]);
+        else if (arg == "--solver-a")
+            settings[0].solver_pieces = atoi(argv[k + 1]);
+        else if (arg == "--solver-b")
+            settings[1].solver_pieces = atoi(argv[k + 1]);
+        else if (arg == "--temperature-a")
+            settings[0].temperature = atof(argv[k + 1]);
+        else if (arg == "--temperature-b")
+            settings[1].temperature = atof(argv[k + 1]);
+        else if (arg == "--multi-pv")
+            settings[0].multi_pv = settings[1].multi_pv = strtoull(argv[k + 1], nullptr, 10);
+        else if (arg == "--workers")
+            settings[0].workers = settings[1].workers = argv[k + 1];
+        else if (arg == "--worker-timeout-ms")
+            settings[0].worker_timeout_ms = settings[1].worker_timeout_ms = atoi(argv[k + 1]);
+    }
+
+    if (depth_b < 0)
+        depth_b = depth;
+    if (size == 10)
+        run_match<geometry<10>>(settings, games, depth, depth_b, max_turns);
+    else
+        run_match<geometry<8>>(settings, games, depth, depth_b, max_turns);
+    return 0;
+}
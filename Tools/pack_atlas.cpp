@@ -0,0 +1,95 @@
+// Сборка атласа основных спрайтов: Textures/atlas.png и индекс Textures/atlas.txt.
+// Запускается из корня проекта перед сборкой игры, Board::start_draw подхватывает атлас автоматически.
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../Models/Project_path.h"
+
+#ifdef __APPLE__
+    #include <SDL2/SDL.h>
+    #include <SDL2/SDL_image.h>
+#else
+    #include <SDL.h>
+    #include <SDL_image.h>
+#endif
+
+using namespace std;
+
+// максимальная ширина атласа, которую гарантированно поддерживают слабые GPU
+const int MaxAtlasWidth = 4096;
+
+struct atlas_item
+{
+    string name;
+    SDL_Surface *surface = nullptr;
+    SDL_Rect dst{0, 0, 0, 0};
+};
+
+int main(int argc, char *argv[])
+{
+    const string textures_path = project_path + "Textures/";
+    // итоговые экраны в атлас не входят: они грузятся лениво при первом показе
+    vector<atlas_item> items = {{"board"},       {"piece_white"}, {"piece_black"}, {"queen_white"},
+                                {"queen_black"}, {"back"},        {"replay"}};
+    for (auto &item : items)
+    {
+        item.surface = IMG_Load((textures_path + item.name + ".png").c_str());
+        if (!item.surface)
+        {
+            cerr << "Can't load " << item.name << ".png: " << IMG_GetError() << endl;
+            return 1;
+        }
+        item.dst.w = item.surface->w;
+        item.dst.h = item.surface->h;
+    }
+
+    // упаковка по полкам: высокие спрайты первыми, полка закрывается при переполнении ширины
+    vector<atlas_item *> order;
+    for (auto &item : items)
+        order.push_back(&item);
+    sort(order.begin(), order.end(), [](atlas_item *a, atlas_item *b) { return a->dst.h > b->dst.h; });
+    int x = 0, y = 0, shelf_h = 0, atlas_w = 0;
+    for (auto item : order)
+    {
+        if (x + item->dst.w > MaxAtlasWidth)
+        {
+            x = 0;
+            y += shelf_h;
+            shelf_h = 0;
+        }
+        item->dst.x = x;
+        item->dst.y = y;
+        x += item->dst.w;
+        shelf_h = max(shelf_h, item->dst.h);
+        atlas_w = max(atlas_w, x);
+    }
+    const int atlas_h = y + shelf_h;
+
+    SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(0, atlas_w, atlas_h, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!atlas)
+    {
+        cerr << "Can't create atlas surface: " << SDL_GetError() << endl;
+        return 1;
+    }
+    ofstream fout(textures_path + "atlas.txt", ios_base::trunc);
+    for (auto &item : items)
+    {
+        // копируем пиксели как есть, без смешивания с пустым фоном атласа
+        SDL_SetSurfaceBlendMode(item.surface, SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(item.surface, nullptr, atlas, &item.dst);
+        fout << item.name << ' ' << item.dst.x << ' ' << item.dst.y << ' ' << item.dst.w << ' ' << item.dst.h << '\n';
+        SDL_FreeSurface(item.surface);
+    }
+    fout.close();
+    if (IMG_SavePNG(atlas, (textures_path + "atlas.png").c_str()) != 0)
+    {
+        cerr << "Can't save atlas: " << IMG_GetError() << endl;
+        return 1;
+    }
+    SDL_FreeSurface(atlas);
+    cout << "Atlas " << atlas_w << "x" << atlas_h << " saved to " << textures_path << endl;
+    return 0;
+}
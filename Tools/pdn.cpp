@@ -0,0 +1,72 @@
+// Проверка и импорт архива партий PDN: каждая партия воспроизводится по правилам движка без графики.
+// Печатает число партий, ходов и ошибок и скорость чтения. --errors - каждая ошибка в stderr
+// (смещение партии в файле, номер полухода, причина), --positions FILE - все позиции проверенных
+// партий в записи position_line для Tools/analyze.cpp (порядок партий между потоками не сохраняется).
+//   pdn [--threads T] [--errors] [--positions FILE] ARCHIVE.pdn
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "../Engine/Pdn.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    int threads = max(1, int(thread::hardware_concurrency()));
+    bool print_errors = false;
+    string path, positions_path;
+    for (int k = 1; k < argc; ++k)
+    {
+        const string arg = argv[k];
+        if (arg == "--threads" && k + 1 < argc)
+            threads = max(1, atoi(argv[++k]));
+        else if (arg == "--errors")
+            print_errors = true;
+        else if (arg == "--positions" && k + 1 < argc)
+            positions_path = argv[++k];
+        else
+            path = arg;
+    }
+    if (path.empty())
+    {
+        cerr << "usage: pdn [--threads T] [--errors] [--positions FILE] ARCHIVE.pdn" << endl;
+        return 1;
+    }
+
+    ofstream positions;
+    if (!positions_path.empty())
+        positions.open(positions_path);
+    mutex out_mutex;
+    auto start = chrono::steady_clock::now();
+    const auto stats = read_pdn(path, threads, [&](const pdn_game &game) {
+        if (!game.error.empty() && print_errors)
+        {
+            lock_guard<mutex> lock(out_mutex);
+            cerr << "offset " << game.offset << ", ply " << game.error_ply << ": " << game.error << "\n";
+        }
+        if (!positions.is_open() || !game.error.empty())
+            return;
+        // позиции партии собираются целиком, чтобы строки одной партии шли подряд
+        string lines = position_line(game.start.empty() ? start_position(game.board_size) : game.start,
+                                     game.start_color) + "\n";
+        for (size_t k = 0; k < game.moves.size(); ++k)
+            lines += position_line(game.moves[k].position, (game.start_color + k + 1) % 2) + "\n";
+        lock_guard<mutex> lock(out_mutex);
+        positions << lines;
+    });
+    if (!stats.opened)
+    {
+        cerr << "cannot open " << path << endl;
+        return 1;
+    }
+    const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "games: " << stats.games << ", moves: " << stats.moves << ", errors: " << stats.errors
+         << ", threads: " << threads << ", time: " << (int)ms << " millisec, games/sec: "
+         << (int)(stats.games / max(ms, 1.0) * 1000) << endl;
+    return stats.errors ? 2 : 0;
+}
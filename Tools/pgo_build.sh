@@ -0,0 +1,31 @@
+#!/bin/sh
+# Оптимизированная сборка с профилем (PGO) и LTO через CMakeLists.txt, запускать из корня проекта.
+# 1) инструментированная сборка, 2) обучающая нагрузка: партии бот против бота (Engine/Selfplay.h),
+# 3) пересборка с профилем и LTO в том же каталоге (GCC ищет профиль по пути объектного файла).
+# Игра, если CMake нашёл SDL2, обучается через "--selfplay", инструменты - на той же нагрузке.
+# Переменные: OUT (каталог сборки), CMAKE_FLAGS (дополнительные флаги cmake, например -DCMAKE_CXX_COMPILER=...).
+set -e
+OUT=${OUT:-build_pgo}
+PROFILE="$(pwd)/$OUT/profile"
+
+rm -rf "$PROFILE"
+cmake -S . -B "$OUT" -DCMAKE_BUILD_TYPE=Release -DCHECKERS_LTO=ON -DCHECKERS_PGO=generate \
+    -DCHECKERS_PGO_DIR="$PROFILE" $CMAKE_FLAGS > /dev/null
+cmake --build "$OUT" -j
+"$OUT/selfplay" --games 20 --depth 4 > /dev/null
+"$OUT/bench" --min-time 20 > /dev/null
+if [ -x "$OUT/checkers" ]; then
+    "$OUT/checkers" --selfplay > /dev/null
+else
+    echo "the game is not built (SDL2 not found), only the engine tools are trained"
+fi
+cmake "$OUT" -DCHECKERS_PGO=use > /dev/null
+cmake --build "$OUT" -j
+
+# сравнение с обычной сборкой Release на той же нагрузке
+cmake -S . -B "$OUT/plain" -DCMAKE_BUILD_TYPE=Release $CMAKE_FLAGS > /dev/null
+cmake --build "$OUT/plain" -j --target selfplay
+echo "plain Release:"
+"$OUT/plain/selfplay" | tail -n 1
+echo "PGO + LTO:"
+"$OUT/selfplay" | tail -n 1
@@ -0,0 +1,37 @@
+// Партии бот против бота без графики: фиксированная нагрузка для профилирования (PGO) и замера узлов в секунду.
+//   selfplay [--games N] [--depth D] [--max-turns T] [--size 8|10]
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "../Engine/Selfplay.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    int games = 20, depth = 4, max_turns = 120, size = 8;
+    for (int k = 1; k + 1 < argc; k += 2)
+    {
+        const string arg = argv[k];
+        if (arg == "--games")
+            games = atoi(argv[k + 1]);
+        else if (arg == "--depth")
+            depth = atoi(argv[k + 1]);
+        else if (arg == "--max-turns")
+            max_turns = atoi(argv[k + 1]);
+        else if (arg == "--size")
+            size = atoi(argv[k + 1]);
+    }
+
+    engine_settings settings;
+    settings.no_random = true;
+    auto res = size == 10 ? selfplay<geometry<10>>(settings, games, depth, max_turns)
+                          : selfplay<geometry<8>>(settings, games, depth, max_turns);
+
+    cout << "games: " << games << ", depth: " << depth << ", board: " << size << "x" << size << "\n";
+    cout << "white wins: " << res.white_wins << ", black wins: " << res.black_wins << ", draws: " << res.draws << "\n";
+    cout << "nodes: " << res.nodes << ", time: " << (int)res.ms << " millisec, nodes/sec: "
+         << (size_t)(res.nodes / (res.ms / 1000)) << "\n";
+    return 0;
+}
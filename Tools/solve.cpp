@@ -0,0 +1,68 @@
+// Анализ позиции решателем df-pn: доказанный выигрыш или проигрыш стороны на ходу и выигрывающий ход.
+// Позиция читается из файла или stdin в записи parse_position (Engine/Position.h): по строке на ряд сверху вниз.
+//   solve [--color white|black] [--nodes N] [--memory-mb MB] [--no-progress-limit K] [FILE]
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../Engine/Logic.h"
+
+using namespace std;
+
+template <class G> int run_solver(const vector<string> &rows, const bool color, const engine_settings &settings)
+{
+    PnSolver<G> solver(settings);
+    auto res = solver.solve(color, parse_position(rows), 0);
+    cout << "result: " << (res.result == 1 ? "win" : res.result == -1 ? "loss" : "unknown") << " for "
+         << (color ? "black" : "white") << "\n";
+    if (res.result == 1)
+    {
+        cout << "best move: " << series_text(res.best) << "\n";
+    }
+    cout << "nodes: " << res.nodes << ", time: " << (int)res.ms << " millisec\n";
+    return res.result == 0 ? 2 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    engine_settings settings;
+    settings.solver_nodes = 5000000;
+    settings.solver_memory_mb = 64;
+    bool color = false;
+    string path;
+    for (int k = 1; k < argc; ++k)
+    {
+        const string arg = argv[k];
+        if (arg == "--color" && k + 1 < argc)
+            color = string(argv[++k]) == "black";
+        else if (arg == "--nodes" && k + 1 < argc)
+            settings.solver_nodes = strtoull(argv[++k], nullptr, 10);
+        else if (arg == "--memory-mb" && k + 1 < argc)
+            settings.solver_memory_mb = atoi(argv[++k]);
+        else if (arg == "--no-progress-limit" && k + 1 < argc)
+            settings.no_progress_limit = atoi(argv[++k]);
+        else
+            path = arg;
+    }
+
+    ifstream fin;
+    if (!path.empty())
+        fin.open(path);
+    istream &in = path.empty() ? cin : fin;
+    vector<string> rows;
+    string line;
+    while (getline(in, line))
+    {
+        if (!line.empty())
+            rows.push_back(line);
+    }
+    if (rows.size() != 8 && rows.size() != 10)
+    {
+        cerr << "expected 8 or 10 rows, got " << rows.size() << endl;
+        return 1;
+    }
+    return rows.size() == 10 ? run_solver<geometry<10>>(rows, color, settings)
+                             : run_solver<geometry<8>>(rows, color, settings);
+}
@@ -0,0 +1,24 @@
+// Воркер распределённого поиска: считает ветки корня, которые раздаёт координатор (Logic с engine = "Distributed"
+// и адресами воркеров в Workers). Обслуживает координаторов по одному, размер доски приходит от координатора.
+//   worker ADDRESS      (unix:/path/worker.sock, tcp:host:port, host:port или tcp:port)
+#include <iostream>
+#include <string>
+
+#include "../Engine/Worker.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "usage: worker ADDRESS" << endl;
+        return 1;
+    }
+    if (!run_worker(argv[1]))
+    {
+        cerr << "cannot listen on " << argv[1] << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,9 +1,32 @@
+#include <cstring>
+
+#include "Engine/Selfplay.h"
 #include "Game/Game.h"
 
 int main(int argc, char* argv[])
 {
-    Game g;
-    g.play();
+    // обучающая нагрузка для сборки с профилем (Tools/pgo_build.sh), окно не создаётся
+    if (argc > 1 && strcmp(argv[1], "--selfplay") == 0)
+    {
+        engine_settings settings;
+        settings.no_random = true;
+        auto res = selfplay(settings, 20, 4, 120);
+        cout << "nodes/sec: " << (size_t)(res.nodes / (res.ms / 1000)) << endl;
+        return 0;
+    }
+
+    // размер доски выбирается в settings.json: 8 - русские шашки, 10 - международные
+    Config config;
+    if (config.board_size() == 10)
+    {
+        Game<geometry<10>> g;
+        g.play();
+    }
+    else
+    {
+        Game<geometry<8>> g;
+        g.play();
+    }
 
     return 0;
 }